@@ -0,0 +1,97 @@
+import argparse
+import numpy as np
+from vertexregen_tokenizer import TokenProducer, quantized_edge_collapse, tokenize_mesh
+from .utils import load_dataset
+
+
+def python_tokens(vertices, faces, num_pos_tokens):
+    # Same steps and filters as create_dataset followed by tokenize_mesh
+    try:
+        stats = quantized_edge_collapse(vertices, faces, num_pos_tokens=num_pos_tokens)
+    except RuntimeError:
+        return None
+    if stats is None or len(stats.vsplit_seq) == 0:
+        return None
+    return np.array(
+        tokenize_mesh(
+            all_vertices=stats.vertices,
+            init_vertices=stats.init_vertices,
+            init_faces=stats.init_faces,
+            vsplit_seq=stats.vsplit_seq,
+        ),
+        dtype=np.int32,
+    )
+
+
+def main():
+    parser = argparse.ArgumentParser()
+    parser.add_argument(
+        "-i",
+        "--input",
+        type=str,
+        default="zx1239856/shapenet",
+        help="Path to the input dataset (HuggingFace dataset format).",
+    )
+    parser.add_argument(
+        "-s",
+        "--split",
+        type=str,
+        default="train",
+        help="Dataset split to use (e.g., train, test, validation).",
+    )
+    parser.add_argument(
+        "-m",
+        "--num-meshes",
+        type=int,
+        default=32,
+        help="Number of meshes to compare.",
+    )
+    parser.add_argument(
+        "-n",
+        "--num-threads",
+        type=int,
+        default=4,
+        help="Number of producer threads.",
+    )
+    parser.add_argument(
+        "-q",
+        "--num-pos-tokens",
+        type=int,
+        default=128,
+        help="Number of position tokens for quantization.",
+    )
+    args = parser.parse_args()
+
+    data = load_dataset(args.input)[args.split]
+    data = data.select(range(min(args.num_meshes, len(data))))
+    meshes = [
+        (np.array(example["vertices"], dtype=np.float64), np.array(example["faces"], dtype=np.int32))
+        for example in data
+    ]
+
+    expected = {}
+    for index, (vertices, faces) in enumerate(meshes):
+        tokens = python_tokens(vertices, faces, args.num_pos_tokens)
+        if tokens is not None:
+            expected[index] = tokens
+
+    # No augmentation, so the producer must reproduce the offline pipeline exactly
+    producer = TokenProducer(meshes, num_pos_tokens=args.num_pos_tokens, num_threads=args.num_threads)
+    produced = {index: tokens for index, tokens in producer}
+
+    assert produced.keys() == expected.keys(), (
+        f"Meshes differ: only in producer {sorted(produced.keys() - expected.keys())}, "
+        f"only in Python {sorted(expected.keys() - produced.keys())}"
+    )
+    for index, tokens in expected.items():
+        assert np.array_equal(produced[index], tokens), (
+            f"Tokens differ for mesh {index} (uid {data[index]['uid']})"
+        )
+    print(
+        f"{len(expected)} of {len(meshes)} meshes tokenized identically "
+        f"({producer.rejected} rejected, {producer.dropped} dropped)"
+    )
+
+
+if __name__ == "__main__":
+    main()
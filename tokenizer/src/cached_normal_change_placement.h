@@ -0,0 +1,242 @@
+#pragma once
+
+#include <CGAL/Surface_mesh.h>
+#include <CGAL/boost/graph/helpers.h>
+#include <CGAL/boost/graph/iterator.h>
+#include <CGAL/Surface_mesh_simplification/Policies/Edge_collapse/Edge_profile.h>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+namespace CGAL::Surface_mesh_simplification
+{
+
+  // Face normals of a Surface_mesh, one per face corner, keyed by the halfedge pointing to the
+  // corner vertex and stored in dense halfedge property maps. Normals are computed on demand.
+  // They are only served during a collapse run wrapped in Normal_cache_visitor, which
+  // invalidates them around every vertex a collapse has moved.
+  template <typename TriangleMesh>
+  class Corner_normal_cache;
+
+  template <typename Point>
+  class Corner_normal_cache<Surface_mesh<Point>>
+  {
+    using TM = Surface_mesh<Point>;
+    using Kernel = typename Kernel_traits<Point>::Kernel;
+    using Vector_3 = typename Kernel::Vector_3;
+
+  public:
+    using halfedge_descriptor = typename boost::graph_traits<TM>::halfedge_descriptor;
+    using vertex_descriptor = typename boost::graph_traits<TM>::vertex_descriptor;
+
+    explicit Corner_normal_cache(TM &tmesh)
+        : m_tmesh(tmesh),
+          m_normals(tmesh.template add_property_map<halfedge_descriptor, Vector_3>("h:corner_normal").first),
+          m_valid(tmesh.template add_property_map<halfedge_descriptor, std::uint8_t>("h:corner_normal_valid", 0).first)
+    {
+    }
+
+    // (p - q) x (r - q), where q is the target of h and p, r are the other vertices of its face
+    const Vector_3 &normal(halfedge_descriptor h)
+    {
+      if (!m_tracking)
+      {
+        throw std::logic_error("Corner_normal_cache used without Normal_cache_visitor");
+      }
+      if (!m_valid[h])
+      {
+        const Kernel gt;
+        const Point &q = m_tmesh.point(target(h, m_tmesh));
+        const Point &p = m_tmesh.point(source(h, m_tmesh));
+        const Point &r = m_tmesh.point(target(next(h, m_tmesh), m_tmesh));
+        m_normals[h] = gt.construct_cross_product_vector_3_object()(
+            gt.construct_vector_3_object()(q, p),
+            gt.construct_vector_3_object()(q, r));
+        m_valid[h] = 1;
+      }
+      return m_normals[h];
+    }
+
+    // Drop the normals of all faces around v
+    void invalidate_around(vertex_descriptor v)
+    {
+      for (halfedge_descriptor h : halfedges_around_target(v, m_tmesh))
+      {
+        if (is_border(h, m_tmesh))
+        {
+          continue;
+        }
+        for (halfedge_descriptor hf : halfedges_around_face(h, m_tmesh))
+        {
+          m_valid[hf] = 0;
+        }
+      }
+    }
+
+    void set_tracking(bool tracking)
+    {
+      m_tracking = tracking;
+    }
+
+  private:
+    const TM &m_tmesh;
+    // Set while a Normal_cache_visitor keeps the normals up to date
+    bool m_tracking = false;
+    typename TM::template Property_map<halfedge_descriptor, Vector_3> m_normals;
+    typename TM::template Property_map<halfedge_descriptor, std::uint8_t> m_valid;
+  };
+
+  // Forwards every event to Visitor and keeps a Corner_normal_cache valid across collapses.
+  // Any edge_collapse run using the cache must take this visitor.
+  template <typename Visitor, typename NormalCache>
+  class Normal_cache_visitor
+  {
+  public:
+    Normal_cache_visitor(Visitor &visitor, NormalCache &cache)
+        : m_visitor(visitor), m_cache(cache)
+    {
+    }
+
+    template <typename TM>
+    void OnStarted(TM &tm)
+    {
+      m_cache.set_tracking(true);
+      m_visitor.OnStarted(tm);
+    }
+
+    template <typename TM>
+    void OnFinished(TM &tm)
+    {
+      m_cache.set_tracking(false);
+      m_visitor.OnFinished(tm);
+    }
+
+    template <typename Profile>
+    void OnStopConditionReached(const Profile &profile)
+    {
+      m_visitor.OnStopConditionReached(profile);
+    }
+
+    template <typename Profile, typename Cost>
+    void OnCollected(const Profile &profile, const Cost &cost)
+    {
+      m_visitor.OnCollected(profile, cost);
+    }
+
+    template <typename Profile, typename Cost, typename Size>
+    void OnSelected(const Profile &profile, const Cost &cost, const Size &initial_count, const Size &current_count)
+    {
+      m_visitor.OnSelected(profile, cost, initial_count, current_count);
+    }
+
+    template <typename Profile, typename Placement>
+    void OnCollapsing(const Profile &profile, const Placement &placement)
+    {
+      m_visitor.OnCollapsing(profile, placement);
+    }
+
+    template <typename Profile>
+    void OnNonCollapsable(const Profile &profile)
+    {
+      m_visitor.OnNonCollapsable(profile);
+    }
+
+    template <typename Profile, typename Vertex>
+    void OnCollapsed(const Profile &profile, const Vertex &v_kept)
+    {
+      m_cache.invalidate_around(v_kept);
+      m_visitor.OnCollapsed(profile, v_kept);
+    }
+
+  private:
+    Visitor &m_visitor;
+    NormalCache &m_cache;
+  };
+
+  // Same rejection rule as Bounded_normal_change_placement: the placement is rejected if the
+  // normal of any face in the star of the edge, except the faces incident to the edge, would
+  // flip or vanish. The normals before the collapse come from a Corner_normal_cache instead of
+  // being recomputed for every candidate. They are computed with the same expression and the
+  // test is invariant to the orientation of the triangle, so decisions are bit-identical.
+  template <typename Placement, typename NormalCache>
+  class Cached_bounded_normal_change_placement
+  {
+  public:
+    Cached_bounded_normal_change_placement(const Placement &placement, NormalCache &cache)
+        : m_placement(placement), m_cache(&cache)
+    {
+    }
+
+    template <typename Profile>
+    auto operator()(const Profile &profile) const
+    {
+      using Vector = typename Profile::Geom_traits::Vector_3;
+      using halfedge_descriptor = typename NormalCache::halfedge_descriptor;
+      using vertex_descriptor = typename NormalCache::vertex_descriptor;
+
+      auto op = m_placement(profile);
+      if (!op)
+      {
+        return op;
+      }
+
+      const auto &tm = profile.surface_mesh();
+      const auto &gt = profile.geom_traits();
+      const auto &vpm = profile.vertex_point_map();
+
+      // Corners at v0 and v1 of the faces not incident to the edge; the faces incident to
+      // the edge are only counted, as the base policy skips the test for stars of <= 2 faces
+      std::size_t num_star_faces = 0;
+      m_corners.clear();
+      auto collect = [&](vertex_descriptor v, vertex_descriptor other, bool count_edge_faces)
+      {
+        for (halfedge_descriptor h : halfedges_around_target(v, tm))
+        {
+          if (is_border(h, tm))
+          {
+            continue;
+          }
+          if (source(h, tm) == other || target(next(h, tm), tm) == other)
+          {
+            if (count_edge_faces)
+            {
+              ++num_star_faces;
+            }
+            continue;
+          }
+          ++num_star_faces;
+          m_corners.push_back(h);
+        }
+      };
+      collect(profile.v0(), profile.v1(), true);
+      collect(profile.v1(), profile.v0(), false);
+      if (num_star_faces <= 2)
+      {
+        return op;
+      }
+
+      const auto &q2 = *op;
+      for (halfedge_descriptor h : m_corners)
+      {
+        const Vector &n1 = m_cache->normal(h);
+        const auto &p = get(vpm, source(h, tm));
+        const auto &r = get(vpm, target(next(h, tm), tm));
+        const Vector n2 = gt.construct_cross_product_vector_3_object()(
+            gt.construct_vector_3_object()(q2, p),
+            gt.construct_vector_3_object()(q2, r));
+        if (!is_positive(gt.compute_scalar_product_3_object()(n1, n2)))
+        {
+          return decltype(op)();
+        }
+      }
+      return op;
+    }
+
+  private:
+    Placement m_placement;
+    NormalCache *m_cache;
+    // Scratch buffer reused across evaluations
+    mutable std::vector<typename NormalCache::halfedge_descriptor> m_corners;
+  };
+
+} // namespace CGAL::Surface_mesh_simplification
@@ -4,6 +4,7 @@
 #include <CGAL/Surface_mesh.h>
 #include <CGAL/Surface_mesh_simplification/edge_collapse.h>
 #include <Eigen/Dense>
+#include <cstdint>
 #include <vector>
 #include <optional>
 
@@ -14,16 +15,43 @@ using Surface_mesh = CGAL::Surface_mesh<Point_3>;
 using halfedge_descriptor = boost::graph_traits<Surface_mesh>::halfedge_descriptor;
 using edge_descriptor = boost::graph_traits<Surface_mesh>::edge_descriptor;
 using vertex_descriptor = boost::graph_traits<Surface_mesh>::vertex_descriptor;
+using Vertex_id_map = Surface_mesh::Property_map<vertex_descriptor, std::size_t>;
 namespace SMS = CGAL::Surface_mesh_simplification;
 
 namespace vr_tokenizer::cgal
 {
+    template <typename Scalar>
+    using VertexArray = Eigen::Array<Scalar, Eigen::Dynamic, 3>;
+    template <typename Index>
+    using FaceArray = Eigen::Array<Index, Eigen::Dynamic, 3>;
+
+    // How much of the collapse history StatsVisitor records
+    enum class RecordLevel
+    {
+        Sequence, // one CollapseInfo per collapse
+        FullInfo, // additionally a snapshot of the mesh after every collapse
+        Columnar, // only Stats::collapse_columns, without per-collapse objects
+    };
+
+    enum class Status
+    {
+        Ok,
+        InvalidMesh,           // mesh could not be converted to a valid Surface_mesh
+        MemoryBudgetExceeded,  // collapse stopped early to stay within the memory budget
+        // Rejected by check_polygon_soup before conversion
+        NonManifoldEdge,          // an edge is shared by more than two faces
+        NonManifoldVertex,        // the faces around a vertex do not form a single fan
+        InconsistentOrientation,  // faces cannot be oriented consistently
+    };
+
     struct PolygonSoup
     {
         Eigen::ArrayX3d vertices;
         Eigen::ArrayX3i faces;
+        std::uint64_t fingerprint = 0;
     };
 
+    // Vertex indices refer to the numbering of Stats::cleaned_mesh
     struct CollapseInfo
     {
         std::size_t v_s;
@@ -36,13 +64,31 @@ namespace vr_tokenizer::cgal
         std::optional<Eigen::Vector3d> v_l_p;
         std::optional<Eigen::Vector3d> v_r_p;
         double dist;
+        std::uint64_t fingerprint; // fingerprint of the mesh after this collapse
         std::optional<PolygonSoup> collapsed_mesh;
     };
 
+    // Struct-of-arrays form of the collapse sequence, one row per collapse, in the same
+    // numbering as CollapseInfo. Preallocated when the collapse starts and trimmed at the end.
+    struct CollapseColumns
+    {
+        using IndexArray = Eigen::Array<std::int32_t, Eigen::Dynamic, 4, Eigen::RowMajor>;
+        using PositionArray = Eigen::Array<double, Eigen::Dynamic, 3, Eigen::RowMajor>;
+
+        IndexArray indices; // v_s, v_t, v_l, v_r with -1 for a missing v_l or v_r
+        PositionArray v_s_p;
+        PositionArray v_t_p;
+        PositionArray v_placement;
+        Eigen::ArrayXd cost; // NaN where the cost was not computable
+        Eigen::Array<std::uint64_t, Eigen::Dynamic, 1> fingerprint;
+    };
+
     struct Stats
     {
         PolygonSoup cleaned_mesh;
         bool is_valid = false;
+        Status status = Status::Ok;
+        size_t peak_memory = 0; // estimated peak bytes of mesh, queue and recorded history
         size_t collected = 0;
         size_t processed = 0;
         size_t collapsed = 0;
@@ -51,6 +97,7 @@ namespace vr_tokenizer::cgal
         size_t placement_uncomputable = 0;
         size_t num_sharp_edges = 0;
         std::vector<CollapseInfo> collapse_sequence;
+        CollapseColumns collapse_columns;
     };
 
 } // namespace vr_tokenizer::cgal
\ No newline at end of file
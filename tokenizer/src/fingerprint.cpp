@@ -0,0 +1,152 @@
+#include <array>
+#include <cstring>
+#include <stdexcept>
+#include "fingerprint.h"
+
+namespace vr_tokenizer::cgal
+{
+    using Position = std::array<double, 3>;
+
+    namespace
+    {
+        // splitmix64 finalizer
+        inline std::uint64_t mix(std::uint64_t x)
+        {
+            x ^= x >> 30;
+            x *= 0xbf58476d1ce4e5b9ULL;
+            x ^= x >> 27;
+            x *= 0x94d049bb133111ebULL;
+            x ^= x >> 31;
+            return x;
+        }
+
+        inline std::uint64_t coord_bits(double v)
+        {
+            // +0.0 and -0.0 describe the same position
+            if (v == 0.0)
+            {
+                v = 0.0;
+            }
+            std::uint64_t bits;
+            std::memcpy(&bits, &v, sizeof(bits));
+            return bits;
+        }
+
+        Fingerprint face_fingerprint(const std::array<Position, 3> &p)
+        {
+            // Canonical rotation: start from the lexicographically smallest rotation,
+            // which keeps orientation and is well defined even with repeated positions
+            std::size_t start = 0;
+            for (std::size_t r = 1; r < 3; ++r)
+            {
+                for (std::size_t k = 0; k < 3; ++k)
+                {
+                    const auto &a = p[(r + k) % 3];
+                    const auto &b = p[(start + k) % 3];
+                    if (a != b)
+                    {
+                        if (a < b)
+                        {
+                            start = r;
+                        }
+                        break;
+                    }
+                }
+            }
+            std::uint64_t h = 0x9e3779b97f4a7c15ULL;
+            for (std::size_t k = 0; k < 3; ++k)
+            {
+                for (const auto c : p[(start + k) % 3])
+                {
+                    h = mix(h + coord_bits(c));
+                }
+            }
+            return h;
+        }
+
+        inline Position to_position(const Point_3 &p)
+        {
+            return {p.x(), p.y(), p.z()};
+        }
+
+        Fingerprint face_fingerprint(const Surface_mesh &mesh, Surface_mesh::Face_index f)
+        {
+            std::array<Position, 3> p;
+            std::size_t i = 0;
+            for (const auto v : vertices_around_face(mesh.halfedge(f), mesh))
+            {
+                if (i == 3)
+                {
+                    throw std::runtime_error("Non-triangular face encountered");
+                }
+                p[i++] = to_position(mesh.point(v));
+            }
+            return face_fingerprint(p);
+        }
+    } // namespace
+
+    Fingerprint mesh_fingerprint(const Surface_mesh &mesh)
+    {
+        Fingerprint fp = 0;
+        for (const auto f : mesh.faces())
+        {
+            fp += face_fingerprint(mesh, f);
+        }
+        return fp;
+    }
+
+    Fingerprint mesh_fingerprint(const Eigen::ArrayX3d &vertices, const Eigen::ArrayX3i &faces)
+    {
+        Fingerprint fp = 0;
+        for (int i = 0; i < faces.rows(); ++i)
+        {
+            std::array<Position, 3> p;
+            for (int k = 0; k < 3; ++k)
+            {
+                const auto v = faces(i, k);
+                if (v < 0 || v >= vertices.rows())
+                {
+                    throw std::out_of_range("Face index out of range");
+                }
+                p[k] = {vertices(v, 0), vertices(v, 1), vertices(v, 2)};
+            }
+            fp += face_fingerprint(p);
+        }
+        return fp;
+    }
+
+    Fingerprint incident_faces_fingerprint(
+        const Surface_mesh &mesh,
+        vertex_descriptor v,
+        std::optional<vertex_descriptor> skip)
+    {
+        Fingerprint fp = 0;
+        const auto h = mesh.halfedge(v);
+        if (h == Surface_mesh::null_halfedge())
+        {
+            return fp;
+        }
+        for (const auto f : faces_around_target(h, mesh))
+        {
+            if (f == Surface_mesh::null_face())
+            {
+                continue;
+            }
+            if (skip.has_value())
+            {
+                bool contains_skip = false;
+                for (const auto u : vertices_around_face(mesh.halfedge(f), mesh))
+                {
+                    contains_skip |= (u == *skip);
+                }
+                if (contains_skip)
+                {
+                    continue;
+                }
+            }
+            fp += face_fingerprint(mesh, f);
+        }
+        return fp;
+    }
+
+} // namespace vr_tokenizer::cgal
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include "common.h"
+
+namespace vr_tokenizer::cgal
+{
+    // Order-independent fingerprint of a triangle mesh. Each face is hashed from its
+    // vertex positions in canonical rotation, and face hashes are summed (mod 2^64),
+    // so the fingerprint does not depend on vertex or face numbering and can be
+    // updated incrementally by subtracting removed faces and adding new ones.
+    using Fingerprint = std::uint64_t;
+
+    Fingerprint mesh_fingerprint(const Surface_mesh &mesh);
+
+    Fingerprint mesh_fingerprint(const Eigen::ArrayX3d &vertices, const Eigen::ArrayX3i &faces);
+
+    // Sum of the fingerprints of all faces incident to `v`, ignoring faces that also contain `skip`
+    Fingerprint incident_faces_fingerprint(
+        const Surface_mesh &mesh,
+        vertex_descriptor v,
+        std::optional<vertex_descriptor> skip = std::nullopt);
+
+} // namespace vr_tokenizer::cgal
@@ -1,8 +1,13 @@
 #include <CGAL/Polygon_mesh_processing/repair_polygon_soup.h>
 #include <CGAL/Polygon_mesh_processing/orient_polygon_soup.h>
 #include <CGAL/Polygon_mesh_processing/polygon_soup_to_polygon_mesh.h>
+#include <algorithm>
 #include <array>
+#include <limits>
+#include <numeric>
 #include <optional>
+#include <unordered_map>
+#include <unordered_set>
 #include "mesh.h"
 
 namespace vr_tokenizer::cgal
@@ -34,9 +39,10 @@ namespace vr_tokenizer::cgal
         Less_xyz_3 less_xyz_3_object() const { return Less_xyz_3(); }
     };
 
+    template <typename Scalar, typename Index>
     std::optional<Surface_mesh> polygon_soup_to_mesh(
-        const Eigen::ArrayX3d &vertices,
-        const Eigen::ArrayX3i &faces,
+        const VertexArray<Scalar> &vertices,
+        const FaceArray<Index> &faces,
         bool strict,
         bool clean)
     {
@@ -46,7 +52,9 @@ namespace vr_tokenizer::cgal
         polygons.reserve(faces.rows());
         for (int i = 0; i < vertices.rows(); ++i)
         {
-            points.push_back({vertices(i, 0), vertices(i, 1), vertices(i, 2)});
+            points.push_back({static_cast<FT>(vertices(i, 0)),
+                              static_cast<FT>(vertices(i, 1)),
+                              static_cast<FT>(vertices(i, 2))});
         }
         for (int i = 0; i < faces.rows(); ++i)
         {
@@ -68,6 +76,233 @@ namespace vr_tokenizer::cgal
         return mesh;
     };
 
+#define INSTANTIATE_POLYGON_SOUP_TO_MESH(Scalar, Index)                       \
+    template std::optional<Surface_mesh> polygon_soup_to_mesh<Scalar, Index>( \
+        const VertexArray<Scalar> &,                                          \
+        const FaceArray<Index> &,                                             \
+        bool,                                                                 \
+        bool);
+
+    INSTANTIATE_POLYGON_SOUP_TO_MESH(float, std::int32_t)
+    INSTANTIATE_POLYGON_SOUP_TO_MESH(float, std::int64_t)
+    INSTANTIATE_POLYGON_SOUP_TO_MESH(double, std::int32_t)
+    INSTANTIATE_POLYGON_SOUP_TO_MESH(double, std::int64_t)
+
+#undef INSTANTIATE_POLYGON_SOUP_TO_MESH
+
+    namespace
+    {
+        struct Custom_point_hash
+        {
+            std::size_t operator()(const Custom_point &p) const
+            {
+                std::size_t h = 0;
+                for (const auto c : p)
+                {
+                    // +0.0 and -0.0 compare equal and must hash equally
+                    h = h * 1000003u ^ std::hash<FT>()(c == FT(0) ? FT(0) : c);
+                }
+                return h;
+            }
+        };
+
+        struct Polygon_hash
+        {
+            std::size_t operator()(const CGAL_Polygon &polygon) const
+            {
+                std::size_t h = 0;
+                for (const auto v : polygon)
+                {
+                    h = h * 1000003u ^ std::hash<std::size_t>()(v);
+                }
+                return h;
+            }
+        };
+
+        // Union-find which also tracks the parity of every element relative to its root
+        class Parity_union_find
+        {
+        public:
+            explicit Parity_union_find(std::size_t n) : m_parent(n), m_parity(n, 0)
+            {
+                std::iota(m_parent.begin(), m_parent.end(), 0);
+            }
+
+            std::pair<std::size_t, bool> find(std::size_t x)
+            {
+                std::size_t root = x;
+                bool parity = false;
+                while (m_parent[root] != root)
+                {
+                    parity ^= m_parity[root];
+                    root = m_parent[root];
+                }
+                // Path compression
+                bool x_parity = parity;
+                while (x != root)
+                {
+                    const std::size_t next = m_parent[x];
+                    const bool next_parity = x_parity ^ m_parity[x];
+                    m_parent[x] = root;
+                    m_parity[x] = x_parity;
+                    x = next;
+                    x_parity = next_parity;
+                }
+                return {root, parity};
+            }
+
+            // Returns false if a and b are already joined with the other parity
+            bool unite(std::size_t a, std::size_t b, bool odd)
+            {
+                const auto [root_a, parity_a] = find(a);
+                const auto [root_b, parity_b] = find(b);
+                if (root_a == root_b)
+                {
+                    return (parity_a ^ parity_b) == odd;
+                }
+                m_parent[root_a] = root_b;
+                m_parity[root_a] = parity_a ^ parity_b ^ odd;
+                return true;
+            }
+
+        private:
+            std::vector<std::size_t> m_parent;
+            std::vector<char> m_parity;
+        };
+    } // namespace
+
+    template <typename Scalar, typename Index>
+    Status check_polygon_soup(
+        const VertexArray<Scalar> &vertices,
+        const FaceArray<Index> &faces)
+    {
+        // Merge identical points
+        std::unordered_map<Custom_point, std::size_t, Custom_point_hash> point_ids;
+        point_ids.reserve(vertices.rows());
+        std::vector<std::size_t> vertex_ids(vertices.rows());
+        for (int i = 0; i < vertices.rows(); ++i)
+        {
+            const Custom_point p = {static_cast<FT>(vertices(i, 0)),
+                                    static_cast<FT>(vertices(i, 1)),
+                                    static_cast<FT>(vertices(i, 2))};
+            vertex_ids[i] = point_ids.emplace(p, point_ids.size()).first->second;
+        }
+        const std::size_t num_points = point_ids.size();
+
+        // Drop degenerate and duplicate faces, regardless of their orientation
+        std::vector<CGAL_Polygon> polygons;
+        polygons.reserve(faces.rows());
+        std::unordered_set<CGAL_Polygon, Polygon_hash> unique_polygons;
+        unique_polygons.reserve(faces.rows());
+        for (int i = 0; i < faces.rows(); ++i)
+        {
+            CGAL_Polygon polygon;
+            for (int k = 0; k < 3; ++k)
+            {
+                const auto v = faces(i, k);
+                if (v < 0 || v >= vertices.rows())
+                {
+                    return Status::InvalidMesh;
+                }
+                polygon[k] = vertex_ids[v];
+            }
+            if (polygon[0] == polygon[1] || polygon[1] == polygon[2] || polygon[2] == polygon[0])
+            {
+                continue;
+            }
+            auto key = polygon;
+            std::sort(key.begin(), key.end());
+            if (unique_polygons.insert(key).second)
+            {
+                polygons.push_back(polygon);
+            }
+        }
+
+        // Faces around every undirected edge, with the source vertex of the edge in that face
+        struct Edge_faces
+        {
+            std::size_t count = 0;
+            std::array<std::size_t, 2> faces;
+            std::array<std::size_t, 2> sources;
+        };
+        std::unordered_map<std::uint64_t, Edge_faces> edges;
+        edges.reserve(polygons.size() * 3 / 2 + 1);
+        for (std::size_t f = 0; f < polygons.size(); ++f)
+        {
+            for (std::size_t k = 0; k < 3; ++k)
+            {
+                const auto a = polygons[f][k];
+                const auto b = polygons[f][(k + 1) % 3];
+                const std::uint64_t key = std::min(a, b) * num_points + std::max(a, b);
+                auto &e = edges[key];
+                if (e.count == 2)
+                {
+                    return Status::NonManifoldEdge;
+                }
+                e.faces[e.count] = f;
+                e.sources[e.count] = a;
+                ++e.count;
+            }
+        }
+
+        auto corner = [&](std::size_t f, std::size_t v)
+        {
+            const auto &polygon = polygons[f];
+            return 3 * f + (polygon[0] == v ? 0 : (polygon[1] == v ? 1 : 2));
+        };
+
+        // Join the corners of a vertex across shared edges into fans, and propagate
+        // orientation: faces sharing an edge must traverse it in opposite directions
+        Parity_union_find fans(3 * polygons.size());
+        Parity_union_find orientation(polygons.size());
+        bool orientable = true;
+        for (const auto &[key, e] : edges)
+        {
+            if (e.count < 2)
+            {
+                continue;
+            }
+            for (const auto v : {key / num_points, key % num_points})
+            {
+                fans.unite(corner(e.faces[0], v), corner(e.faces[1], v), false);
+            }
+            orientable &= orientation.unite(e.faces[0], e.faces[1], e.sources[0] == e.sources[1]);
+        }
+
+        std::vector<std::size_t> vertex_fan(num_points, std::numeric_limits<std::size_t>::max());
+        for (std::size_t c = 0; c < 3 * polygons.size(); ++c)
+        {
+            const auto v = polygons[c / 3][c % 3];
+            const auto root = fans.find(c).first;
+            if (vertex_fan[v] == std::numeric_limits<std::size_t>::max())
+            {
+                vertex_fan[v] = root;
+            }
+            else if (vertex_fan[v] != root)
+            {
+                return Status::NonManifoldVertex;
+            }
+        }
+
+        if (!orientable)
+        {
+            return Status::InconsistentOrientation;
+        }
+        return Status::Ok;
+    }
+
+#define INSTANTIATE_CHECK_POLYGON_SOUP(Scalar, Index)  \
+    template Status check_polygon_soup<Scalar, Index>( \
+        const VertexArray<Scalar> &,                   \
+        const FaceArray<Index> &);
+
+    INSTANTIATE_CHECK_POLYGON_SOUP(float, std::int32_t)
+    INSTANTIATE_CHECK_POLYGON_SOUP(float, std::int64_t)
+    INSTANTIATE_CHECK_POLYGON_SOUP(double, std::int32_t)
+    INSTANTIATE_CHECK_POLYGON_SOUP(double, std::int64_t)
+
+#undef INSTANTIATE_CHECK_POLYGON_SOUP
+
     PolygonSoup mesh_to_polygon_soup(const Surface_mesh &mesh)
     {
         PolygonSoup soup;
@@ -100,4 +335,38 @@ namespace vr_tokenizer::cgal
         }
         return soup;
     }
+
+    Vertex_id_map add_stable_vertex_ids(Surface_mesh &mesh)
+    {
+        auto ids = mesh.add_property_map<vertex_descriptor, std::size_t>("v:stable_id", 0).first;
+        std::size_t v_idx = 0;
+        for (const auto v : mesh.vertices())
+        {
+            ids[v] = v_idx++;
+        }
+        return ids;
+    }
+
+    std::size_t mesh_bytes(const Surface_mesh &mesh)
+    {
+        using Vertex_index = Surface_mesh::Vertex_index;
+        using Halfedge_index = Surface_mesh::Halfedge_index;
+        using Face_index = Surface_mesh::Face_index;
+        // connectivity, removal flags and the point property of Surface_mesh
+        const std::size_t vertex_bytes = sizeof(Point_3) + sizeof(Halfedge_index) + sizeof(bool);
+        const std::size_t halfedge_bytes = 2 * sizeof(Halfedge_index) + sizeof(Vertex_index) + sizeof(Face_index);
+        const std::size_t edge_bytes = sizeof(bool);
+        const std::size_t face_bytes = sizeof(Halfedge_index) + sizeof(bool);
+        return mesh.num_vertices() * vertex_bytes +
+               mesh.num_halfedges() * halfedge_bytes +
+               mesh.num_edges() * edge_bytes +
+               mesh.num_faces() * face_bytes;
+    }
+
+    std::size_t polygon_soup_bytes(const PolygonSoup &soup)
+    {
+        return sizeof(PolygonSoup) +
+               soup.vertices.size() * sizeof(double) +
+               soup.faces.size() * sizeof(int);
+    }
 }
\ No newline at end of file
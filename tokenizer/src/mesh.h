@@ -5,12 +5,32 @@
 namespace vr_tokenizer::cgal
 {
 
+    // Instantiated for float/double vertices and int32/int64 faces
+    template <typename Scalar, typename Index>
     std::optional<Surface_mesh> polygon_soup_to_mesh(
-        const Eigen::ArrayX3d &vertices,
-        const Eigen::ArrayX3i &faces,
+        const VertexArray<Scalar> &vertices,
+        const FaceArray<Index> &faces,
         bool strict,
         bool clean);
 
+    // Linear-time check of a raw triangle soup for defects that make orient_polygon_soup fail.
+    // Identical points are merged and degenerate or duplicate faces dropped first, as
+    // repair_polygon_soup would do, so a rejected soup also fails the strict conversion.
+    // Instantiated for float/double vertices and int32/int64 faces
+    template <typename Scalar, typename Index>
+    Status check_polygon_soup(
+        const VertexArray<Scalar> &vertices,
+        const FaceArray<Index> &faces);
+
     PolygonSoup mesh_to_polygon_soup(const Surface_mesh &mesh);
 
+    // Attach to every vertex its index in mesh_to_polygon_soup(mesh). Collapses keep the map
+    // up to date, so indices stay stable while the mesh is being simplified.
+    Vertex_id_map add_stable_vertex_ids(Surface_mesh &mesh);
+
+    // Estimated heap bytes held by a mesh, including removed but not yet collected elements
+    std::size_t mesh_bytes(const Surface_mesh &mesh);
+
+    std::size_t polygon_soup_bytes(const PolygonSoup &soup);
+
 } // namespace vr_tokenizer::cgal
\ No newline at end of file
@@ -0,0 +1,192 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <exception>
+#include <random>
+#include <stdexcept>
+#include <utility>
+#include "producer.h"
+
+namespace vr_tokenizer::cgal
+{
+    namespace
+    {
+        // Spin briefly, then yield, then sleep while the buffer is full or empty
+        void backoff(unsigned attempt)
+        {
+            if (attempt < 16)
+            {
+                return;
+            }
+            if (attempt < 64)
+            {
+                std::this_thread::yield();
+                return;
+            }
+            std::this_thread::sleep_for(std::chrono::microseconds(50));
+        }
+
+        Eigen::ArrayX3d augment(const Eigen::ArrayX3d &vertices, const ProducerConfig &config, std::mt19937_64 &rng)
+        {
+            Eigen::ArrayX3d result = vertices;
+            if (config.random_rotation)
+            {
+                std::uniform_real_distribution<double> angle(0.0, 2.0 * 3.14159265358979323846);
+                const double a = angle(rng);
+                const double c = std::cos(a);
+                const double s = std::sin(a);
+                const Eigen::ArrayXd x = result.col(0);
+                const Eigen::ArrayXd z = result.col(2);
+                result.col(0) = c * x + s * z;
+                result.col(2) = c * z - s * x;
+            }
+            if (config.scale_jitter > 0)
+            {
+                std::uniform_real_distribution<double> factor(1.0 - config.scale_jitter, 1.0 + config.scale_jitter);
+                for (Eigen::Index k = 0; k < 3; ++k)
+                {
+                    result.col(k) *= factor(rng);
+                }
+            }
+            return result;
+        }
+    } // namespace
+
+    TokenProducer::TokenProducer(std::vector<PolygonSoup> meshes, const ProducerConfig &config)
+        : m_meshes(std::move(meshes)), m_config(config), m_buffer(config.capacity)
+    {
+        // Factors <= 0 would collapse or mirror the mesh
+        if (!(config.scale_jitter >= 0 && config.scale_jitter < 1))
+        {
+            throw std::invalid_argument("scale_jitter must be in [0, 1)");
+        }
+        if (config.tokenizer.num_pos_tokens < 1)
+        {
+            throw std::invalid_argument("num_pos_tokens must be positive");
+        }
+        const std::size_t num_threads = std::max<std::size_t>(config.num_threads, 1);
+        m_active_workers.store(num_threads);
+        m_threads.reserve(num_threads);
+        for (std::size_t i = 0; i < num_threads; ++i)
+        {
+            m_threads.emplace_back(&TokenProducer::work, this);
+        }
+    }
+
+    TokenProducer::~TokenProducer()
+    {
+        stop();
+    }
+
+    void TokenProducer::stop()
+    {
+        m_stop.store(true);
+        for (auto &thread : m_threads)
+        {
+            if (thread.joinable())
+            {
+                thread.join();
+            }
+        }
+    }
+
+    NextResult TokenProducer::next(TokenSample &sample, std::chrono::milliseconds timeout)
+    {
+        const auto deadline = std::chrono::steady_clock::now() + timeout;
+        for (unsigned attempt = 0;; ++attempt)
+        {
+            if (m_buffer.try_pop(sample))
+            {
+                return NextResult::Sample;
+            }
+            if (m_active_workers.load(std::memory_order_acquire) == 0)
+            {
+                // Workers push before leaving, so one more pop sees everything they produced
+                return m_buffer.try_pop(sample) ? NextResult::Sample : NextResult::Exhausted;
+            }
+            if (std::chrono::steady_clock::now() >= deadline)
+            {
+                return NextResult::Timeout;
+            }
+            backoff(attempt);
+        }
+    }
+
+    bool TokenProducer::finish_in_pass(std::size_t sample_index, bool produced)
+    {
+        // Taken once per sample, which is negligible next to the collapse
+        std::lock_guard<std::mutex> lock(m_pass_mutex);
+        const std::size_t pass = sample_index / m_meshes.size();
+        auto &count = m_passes[pass];
+        ++count.finished;
+        count.produced += produced ? 1 : 0;
+        if (count.finished < m_meshes.size())
+        {
+            return false;
+        }
+        const bool empty_pass = count.produced == 0;
+        m_passes.erase(pass);
+        return empty_pass;
+    }
+
+    void TokenProducer::work()
+    {
+        while (!m_stop.load(std::memory_order_relaxed) && !m_meshes.empty())
+        {
+            const std::size_t sample_index = m_next_sample.fetch_add(1);
+            if (!m_config.repeat && sample_index >= m_meshes.size())
+            {
+                break;
+            }
+            const std::size_t mesh_index = sample_index % m_meshes.size();
+            const PolygonSoup &mesh = m_meshes[mesh_index];
+
+            // Seeded per sample so augmentation does not depend on thread scheduling
+            const std::uint64_t index = sample_index;
+            std::seed_seq seq{static_cast<std::uint32_t>(m_config.seed), static_cast<std::uint32_t>(m_config.seed >> 32),
+                              static_cast<std::uint32_t>(index), static_cast<std::uint32_t>(index >> 32)};
+            std::mt19937_64 rng(seq);
+            std::optional<std::vector<std::int32_t>> tokens;
+            try
+            {
+                tokens = tokenize_raw_mesh(augment(mesh.vertices, m_config, rng), mesh.faces, m_config.tokenizer);
+            }
+            catch (const std::exception &)
+            {
+                // CGAL throws on some degenerate inputs; an exception must not leave the thread
+                tokens.reset();
+            }
+            const bool too_long = tokens && m_config.max_tokens > 0 && tokens->size() > m_config.max_tokens;
+            if (!tokens || too_long)
+            {
+                (tokens ? m_dropped : m_rejected).fetch_add(1, std::memory_order_relaxed);
+                // In repeat mode a dataset where every mesh fails would otherwise spin forever
+                if (m_config.repeat && finish_in_pass(sample_index, false))
+                {
+                    m_starved.store(true, std::memory_order_relaxed);
+                    m_stop.store(true);
+                    break;
+                }
+                continue;
+            }
+            if (m_config.repeat)
+            {
+                finish_in_pass(sample_index, true);
+            }
+
+            TokenSample sample{mesh_index, std::move(*tokens)};
+            for (unsigned attempt = 0; !m_buffer.try_push(sample); ++attempt)
+            {
+                if (m_stop.load(std::memory_order_relaxed))
+                {
+                    m_active_workers.fetch_sub(1, std::memory_order_release);
+                    return;
+                }
+                backoff(attempt);
+            }
+            m_produced.fetch_add(1, std::memory_order_relaxed);
+        }
+        m_active_workers.fetch_sub(1, std::memory_order_release);
+    }
+
+} // namespace vr_tokenizer::cgal
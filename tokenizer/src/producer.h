@@ -0,0 +1,101 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "common.h"
+#include "ring_buffer.h"
+#include "tokenize.h"
+
+namespace vr_tokenizer::cgal
+{
+    struct ProducerConfig
+    {
+        TokenizerConfig tokenizer;
+        std::size_t num_threads = 4;
+        // Number of samples buffered ahead of the consumer, rounded up to a power of two
+        std::size_t capacity = 64;
+        // Samples with more tokens are dropped, 0 for no limit
+        std::size_t max_tokens = 0;
+        // Cycle through the meshes until stopped instead of producing every mesh once
+        bool repeat = false;
+        // Rotate every mesh by a random angle about the Y (up) axis before quantization
+        bool random_rotation = false;
+        // Scale every axis by a random factor in [1 - scale_jitter, 1 + scale_jitter], must be in [0, 1)
+        double scale_jitter = 0.0;
+        std::uint64_t seed = 0;
+    };
+
+    struct TokenSample
+    {
+        std::size_t mesh_index = 0;
+        std::vector<std::int32_t> tokens;
+    };
+
+    enum class NextResult
+    {
+        Sample,    // a sample was returned
+        Timeout,   // nothing arrived in time, more samples may follow
+        Exhausted, // all workers are done and every sample was consumed
+    };
+
+    // Thread pool that augments, collapses and tokenizes raw meshes and hands the samples to a
+    // single consumer through a lock-free ring buffer. Samples arrive in completion order.
+    class TokenProducer
+    {
+    public:
+        TokenProducer(std::vector<PolygonSoup> meshes, const ProducerConfig &config);
+        ~TokenProducer();
+
+        TokenProducer(const TokenProducer &) = delete;
+        TokenProducer &operator=(const TokenProducer &) = delete;
+
+        // Waits up to timeout for a sample, so callers can handle interrupts between waits
+        NextResult next(TokenSample &sample, std::chrono::milliseconds timeout);
+
+        // True if the workers gave up because a full pass over the meshes produced no sample
+        bool starved() const { return m_starved.load(std::memory_order_relaxed); }
+
+        // Stops and joins the workers; samples already buffered can still be consumed
+        void stop();
+
+        std::size_t produced() const { return m_produced.load(std::memory_order_relaxed); }
+        std::size_t rejected() const { return m_rejected.load(std::memory_order_relaxed); }
+        std::size_t dropped() const { return m_dropped.load(std::memory_order_relaxed); }
+
+    private:
+        void work();
+
+        // Count a finished sample towards its pass over the meshes. Returns true once a pass
+        // has finished without producing any sample.
+        bool finish_in_pass(std::size_t sample_index, bool produced);
+
+        const std::vector<PolygonSoup> m_meshes;
+        const ProducerConfig m_config;
+        RingBuffer<TokenSample> m_buffer;
+        std::atomic<std::size_t> m_next_sample{0};
+        std::atomic<std::size_t> m_active_workers{0};
+        std::atomic<bool> m_stop{false};
+        std::atomic<std::size_t> m_produced{0};
+        // Meshes rejected by the collapse
+        std::atomic<std::size_t> m_rejected{0};
+        // Samples longer than max_tokens
+        std::atomic<std::size_t> m_dropped{0};
+        // Finished and produced samples of the passes in flight, only tracked in repeat mode
+        struct PassCount
+        {
+            std::size_t finished = 0;
+            std::size_t produced = 0;
+        };
+        std::mutex m_pass_mutex;
+        std::unordered_map<std::size_t, PassCount> m_passes;
+        std::atomic<bool> m_starved{false};
+        std::vector<std::thread> m_threads;
+    };
+
+} // namespace vr_tokenizer::cgal
@@ -2,7 +2,11 @@
 #include <pybind11/numpy.h>
 #include <pybind11/pybind11.h>
 #include <pybind11/stl.h>
+#include <chrono>
 #include "common.h"
+#include "fingerprint.h"
+#include "mesh.h"
+#include "producer.h"
 #include "simplify.h"
 
 #define STRINGIFY(x) #x
@@ -12,12 +16,12 @@ namespace py = pybind11;
 
 using namespace vr_tokenizer::cgal;
 
-PYBIND11_MODULE(_vertexregen_tokenizer_pybind, m)
+template <typename Scalar, typename Index>
+void def_edge_collapse_with_record(py::module_ &m)
 {
-    m.doc() = "Python binding of VertexRegen tokenizer";
     m.def(
         "edge_collapse_with_record",
-        &edge_collapse_with_record,
+        &edge_collapse_with_record<Scalar, Index>,
         "Simplify a triangle mesh with edge collapse and vertex split sequence",
         py::arg("vertices"),
         py::arg("faces"),
@@ -26,7 +30,36 @@ PYBIND11_MODULE(_vertexregen_tokenizer_pybind, m)
         py::arg("no_placement") = false,
         py::arg("sharp_angle_threshold") = -1,
         py::arg("strict") = false,
-        py::arg("record_full_info") = false);
+        py::arg("record_full_info") = false,
+        py::arg("memory_budget") = 0,
+        py::arg("columnar") = false);
+}
+
+template <typename Scalar, typename Index>
+void def_check_polygon_soup(py::module_ &m)
+{
+    m.def(
+        "check_polygon_soup",
+        &check_polygon_soup<Scalar, Index>,
+        "Linear-time check for defects that make strict mesh conversion fail",
+        py::arg("vertices"),
+        py::arg("faces"));
+}
+
+PYBIND11_MODULE(_vertexregen_tokenizer_pybind, m)
+{
+    m.doc() = "Python binding of VertexRegen tokenizer";
+    // One overload per vertex/face dtype, so float32/int64 arrays are taken as-is
+    // instead of being cast first; other dtypes fall back to the (double, int32) overload
+    def_edge_collapse_with_record<double, std::int32_t>(m);
+    def_edge_collapse_with_record<double, std::int64_t>(m);
+    def_edge_collapse_with_record<float, std::int32_t>(m);
+    def_edge_collapse_with_record<float, std::int64_t>(m);
+
+    def_check_polygon_soup<double, std::int32_t>(m);
+    def_check_polygon_soup<double, std::int64_t>(m);
+    def_check_polygon_soup<float, std::int32_t>(m);
+    def_check_polygon_soup<float, std::int64_t>(m);
 
     m.def(
         "vertex_split",
@@ -39,10 +72,26 @@ PYBIND11_MODULE(_vertexregen_tokenizer_pybind, m)
         py::arg("v_r"),
         py::arg("v_t"));
 
+    m.def(
+        "mesh_fingerprint",
+        py::overload_cast<const Eigen::ArrayX3d &, const Eigen::ArrayX3i &>(&mesh_fingerprint),
+        "Order-independent fingerprint of a triangle mesh",
+        py::arg("vertices"),
+        py::arg("faces"));
+
+    py::enum_<Status>(m, "Status")
+        .value("OK", Status::Ok)
+        .value("INVALID_MESH", Status::InvalidMesh)
+        .value("MEMORY_BUDGET_EXCEEDED", Status::MemoryBudgetExceeded)
+        .value("NON_MANIFOLD_EDGE", Status::NonManifoldEdge)
+        .value("NON_MANIFOLD_VERTEX", Status::NonManifoldVertex)
+        .value("INCONSISTENT_ORIENTATION", Status::InconsistentOrientation);
+
     py::class_<PolygonSoup>(m, "PolygonSoup")
         .def(py::init<>()) // Default constructor
         .def_readonly("vertices", &PolygonSoup::vertices)
-        .def_readonly("faces", &PolygonSoup::faces);
+        .def_readonly("faces", &PolygonSoup::faces)
+        .def_readonly("fingerprint", &PolygonSoup::fingerprint);
 
     py::class_<CollapseInfo>(m, "CollapseInfo")
         .def(py::init<>()) // Default constructor
@@ -56,12 +105,24 @@ PYBIND11_MODULE(_vertexregen_tokenizer_pybind, m)
         .def_readonly("v_l_p", &CollapseInfo::v_l_p)
         .def_readonly("v_r_p", &CollapseInfo::v_r_p)
         .def_readonly("dist", &CollapseInfo::dist)
+        .def_readonly("fingerprint", &CollapseInfo::fingerprint)
         .def_readonly("collapsed_mesh", &CollapseInfo::collapsed_mesh);
 
+    py::class_<CollapseColumns>(m, "CollapseColumns")
+        .def(py::init<>()) // Default constructor
+        .def_readonly("indices", &CollapseColumns::indices)
+        .def_readonly("v_s_p", &CollapseColumns::v_s_p)
+        .def_readonly("v_t_p", &CollapseColumns::v_t_p)
+        .def_readonly("v_placement", &CollapseColumns::v_placement)
+        .def_readonly("cost", &CollapseColumns::cost)
+        .def_readonly("fingerprint", &CollapseColumns::fingerprint);
+
     py::class_<Stats>(m, "Stats")
         .def(py::init<>()) // Default constructor
         .def_readonly("cleaned_mesh", &Stats::cleaned_mesh)
         .def_readonly("is_valid", &Stats::is_valid)
+        .def_readonly("status", &Stats::status)
+        .def_readonly("peak_memory", &Stats::peak_memory)
         .def_readonly("collected", &Stats::collected)
         .def_readonly("processed", &Stats::processed)
         .def_readonly("collapsed", &Stats::collapsed)
@@ -69,7 +130,100 @@ PYBIND11_MODULE(_vertexregen_tokenizer_pybind, m)
         .def_readonly("cost_uncomputable", &Stats::cost_uncomputable)
         .def_readonly("placement_uncomputable", &Stats::placement_uncomputable)
         .def_readonly("num_sharp_edges", &Stats::num_sharp_edges)
-        .def_readonly("collapse_sequence", &Stats::collapse_sequence);
+        .def_readonly("collapse_sequence", &Stats::collapse_sequence)
+        .def_readonly("collapse_columns", &Stats::collapse_columns);
+
+    py::class_<TokenProducer>(m, "TokenProducer")
+        .def(
+            py::init(
+                [](const std::vector<std::pair<Eigen::ArrayX3d, Eigen::ArrayX3i>> &meshes,
+                   int num_pos_tokens,
+                   std::size_t num_threads,
+                   std::size_t capacity,
+                   std::size_t max_tokens,
+                   bool repeat,
+                   bool random_rotation,
+                   double scale_jitter,
+                   std::uint64_t seed,
+                   std::int32_t bos_token_id,
+                   std::int32_t eos_token_id,
+                   std::int32_t sep_token_id,
+                   std::int32_t nil_token_id,
+                   std::int32_t pos_token_offset)
+                {
+                    std::vector<PolygonSoup> soups;
+                    soups.reserve(meshes.size());
+                    for (const auto &[vertices, faces] : meshes)
+                    {
+                        soups.push_back({vertices, faces});
+                    }
+                    ProducerConfig config;
+                    config.tokenizer = {num_pos_tokens, bos_token_id, eos_token_id, sep_token_id, nil_token_id, pos_token_offset};
+                    config.num_threads = num_threads;
+                    config.capacity = capacity;
+                    config.max_tokens = max_tokens;
+                    config.repeat = repeat;
+                    config.random_rotation = random_rotation;
+                    config.scale_jitter = scale_jitter;
+                    config.seed = seed;
+                    return std::make_unique<TokenProducer>(std::move(soups), config);
+                }),
+            "Start worker threads that augment, collapse and tokenize (vertices, faces) meshes",
+            py::arg("meshes"),
+            py::arg("num_pos_tokens"),
+            py::arg("num_threads") = 4,
+            py::arg("capacity") = 64,
+            py::arg("max_tokens") = 0,
+            py::arg("repeat") = false,
+            py::arg("random_rotation") = false,
+            py::arg("scale_jitter") = 0.0,
+            py::arg("seed") = 0,
+            py::arg("bos_token_id") = 1,
+            py::arg("eos_token_id") = 2,
+            py::arg("sep_token_id") = 3,
+            py::arg("nil_token_id") = 4,
+            py::arg("pos_token_offset") = 5)
+        .def("__iter__", [](TokenProducer &self) -> TokenProducer & { return self; }, py::return_value_policy::reference_internal)
+        .def(
+            "__next__",
+            [](TokenProducer &self)
+            {
+                TokenSample sample;
+                for (;;)
+                {
+                    NextResult result;
+                    {
+                        py::gil_scoped_release release;
+                        result = self.next(sample, std::chrono::milliseconds(100));
+                    }
+                    if (result == NextResult::Sample)
+                    {
+                        break;
+                    }
+                    if (result == NextResult::Exhausted)
+                    {
+                        if (self.starved())
+                        {
+                            throw std::runtime_error("TokenProducer stopped: a full pass over the meshes produced no sample");
+                        }
+                        throw py::stop_iteration();
+                    }
+                    // Let Ctrl-C and other signal handlers run between waits
+                    if (PyErr_CheckSignals() != 0)
+                    {
+                        throw py::error_already_set();
+                    }
+                }
+                // The array takes over the token buffer instead of copying it
+                auto *tokens = new std::vector<std::int32_t>(std::move(sample.tokens));
+                py::capsule owner(tokens, [](void *p)
+                                  { delete static_cast<std::vector<std::int32_t> *>(p); });
+                return py::make_tuple(sample.mesh_index, py::array_t<std::int32_t>(tokens->size(), tokens->data(), owner));
+            })
+        .def("stop", &TokenProducer::stop, py::call_guard<py::gil_scoped_release>())
+        .def_property_readonly("produced", &TokenProducer::produced)
+        .def_property_readonly("rejected", &TokenProducer::rejected)
+        .def_property_readonly("dropped", &TokenProducer::dropped);
 
 #ifdef VERSION_INFO
     m.attr("__version__") = MACRO_STRINGIFY(VERSION_INFO);
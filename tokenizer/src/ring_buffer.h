@@ -0,0 +1,113 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+namespace vr_tokenizer
+{
+    // Bounded lock-free multi-producer multi-consumer queue (Vyukov). Every slot carries a
+    // sequence number telling whether it is ready to be written or read at a given position.
+    template <typename T>
+    class RingBuffer
+    {
+    public:
+        // capacity is rounded up to a power of two
+        explicit RingBuffer(std::size_t capacity)
+        {
+            std::size_t size = 2;
+            while (size < capacity)
+            {
+                size <<= 1;
+            }
+            m_mask = size - 1;
+            m_slots.reset(new Slot[size]);
+            for (std::size_t i = 0; i < size; ++i)
+            {
+                m_slots[i].sequence.store(i, std::memory_order_relaxed);
+            }
+        }
+
+        RingBuffer(const RingBuffer &) = delete;
+        RingBuffer &operator=(const RingBuffer &) = delete;
+
+        // Moves value into the buffer, returns false if the buffer is full
+        bool try_push(T &value)
+        {
+            std::size_t pos = m_head.load(std::memory_order_relaxed);
+            for (;;)
+            {
+                Slot &slot = m_slots[pos & m_mask];
+                const std::size_t seq = slot.sequence.load(std::memory_order_acquire);
+                const auto diff = static_cast<std::intptr_t>(seq) - static_cast<std::intptr_t>(pos);
+                if (diff == 0)
+                {
+                    if (m_head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    {
+                        slot.value = std::move(value);
+                        slot.sequence.store(pos + 1, std::memory_order_release);
+                        return true;
+                    }
+                }
+                else if (diff < 0)
+                {
+                    return false;
+                }
+                else
+                {
+                    pos = m_head.load(std::memory_order_relaxed);
+                }
+            }
+        }
+
+        // Moves the oldest element into value, returns false if the buffer is empty
+        bool try_pop(T &value)
+        {
+            std::size_t pos = m_tail.load(std::memory_order_relaxed);
+            for (;;)
+            {
+                Slot &slot = m_slots[pos & m_mask];
+                const std::size_t seq = slot.sequence.load(std::memory_order_acquire);
+                const auto diff = static_cast<std::intptr_t>(seq) - static_cast<std::intptr_t>(pos + 1);
+                if (diff == 0)
+                {
+                    if (m_tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    {
+                        value = std::move(slot.value);
+                        slot.sequence.store(pos + m_mask + 1, std::memory_order_release);
+                        return true;
+                    }
+                }
+                else if (diff < 0)
+                {
+                    return false;
+                }
+                else
+                {
+                    pos = m_tail.load(std::memory_order_relaxed);
+                }
+            }
+        }
+
+        std::size_t capacity() const
+        {
+            return m_mask + 1;
+        }
+
+    private:
+        struct Slot
+        {
+            std::atomic<std::size_t> sequence;
+            T value;
+        };
+
+        std::unique_ptr<Slot[]> m_slots;
+        std::size_t m_mask = 0;
+        // Producers and consumers advance different counters; keep them on separate cache lines
+        alignas(64) std::atomic<std::size_t> m_head{0};
+        alignas(64) std::atomic<std::size_t> m_tail{0};
+    };
+
+} // namespace vr_tokenizer
@@ -1,8 +1,11 @@
 #include <CGAL/Surface_mesh_simplification/Policies/Edge_collapse/GarlandHeckbert_policies.h>
-#include <CGAL/Surface_mesh_simplification/Policies/Edge_collapse/Bounded_normal_change_placement.h>
 #include <CGAL/Surface_mesh_simplification/Policies/Edge_collapse/Constrained_placement.h>
 #include <CGAL/Unique_hash_map.h>
+#include <stdexcept>
+#include <type_traits>
+#include "cached_normal_change_placement.h"
 #include "common.h"
+#include "fingerprint.h"
 #include "garland_heckbert_no_placement.h"
 #include "mesh.h"
 #include "simplify.h"
@@ -16,6 +19,7 @@ namespace vr_tokenizer::cgal
 
   using Classic_plane = SMS::GarlandHeckbert_plane_policies<Surface_mesh, Kernel>;
   using Classic_plane_no_placement = SMS::GarlandHeckbert_plane_no_placement_policies<Surface_mesh, Kernel>;
+  using Normal_cache = SMS::Corner_normal_cache<Surface_mesh>;
 
   struct Constrained_edge_map
   {
@@ -50,17 +54,39 @@ namespace vr_tokenizer::cgal
     return get(CGAL::vertex_point, sm, vd);
   }
 
-  template <typename GH_policies>
-  Stats edge_collapse_with_record_impl(
-      const ArrayX3d &vertices,
-      const ArrayX3i &faces,
-      std::size_t target_number_of_vertices,
-      std::size_t target_number_of_triangles,
-      double sharp_angle_threshold,
+  // Estimated bytes held during collapse besides the recorded history: the mesh, the cleaned
+  // soup, the per-vertex quadrics and stable ids, the cached corner normals and the per-edge
+  // data of the collapse queue
+  std::size_t collapse_base_bytes(const Surface_mesh &mesh, const PolygonSoup &cleaned_mesh)
+  {
+    const std::size_t vertex_bytes = sizeof(Matrix4d) + sizeof(std::size_t);
+    const std::size_t halfedge_bytes = sizeof(Kernel::Vector_3) + sizeof(std::uint8_t);
+    const std::size_t edge_bytes = sizeof(std::optional<double>) + sizeof(std::optional<Point_3>) + 4 * sizeof(std::size_t);
+    return mesh_bytes(mesh) + polygon_soup_bytes(cleaned_mesh) +
+           mesh.num_vertices() * vertex_bytes +
+           mesh.num_halfedges() * halfedge_bytes +
+           mesh.num_edges() * edge_bytes;
+  }
+
+  // Convert the input soup and record the cleaned mesh. This is the only part that depends on
+  // the input dtypes; the collapse itself is compiled once for all of them.
+  template <typename Scalar, typename Index>
+  std::optional<Surface_mesh> prepare_mesh(
+      const VertexArray<Scalar> &vertices,
+      const FaceArray<Index> &faces,
       bool strict,
-      bool record_full_info)
+      Stats &stats)
   {
-    Stats stats;
+    if (strict)
+    {
+      // Reject soups that cannot pass the strict conversion before any CGAL work
+      stats.status = check_polygon_soup(vertices, faces);
+      if (stats.status != Status::Ok)
+      {
+        return std::nullopt;
+      }
+    }
+
     auto mesh_opt = polygon_soup_to_mesh(vertices, faces, strict, true);
 
     bool is_valid = mesh_opt.has_value() && mesh_opt->is_valid();
@@ -69,36 +95,67 @@ namespace vr_tokenizer::cgal
     // Do not operate on non-manifold meshes
     if (!is_valid)
     {
-      return stats;
+      stats.status = Status::InvalidMesh;
+      return std::nullopt;
     }
 
-    auto &mesh = mesh_opt.value();
-
-    stats.cleaned_mesh = mesh_to_polygon_soup(mesh);
+    stats.cleaned_mesh = mesh_to_polygon_soup(*mesh_opt);
+    stats.cleaned_mesh.fingerprint = mesh_fingerprint(*mesh_opt);
+    return mesh_opt;
+  }
 
+  template <typename GH_policies, bool ConstrainSharpEdges, RecordLevel Level, bool Budgeted>
+  void edge_collapse_with_record_impl(
+      Surface_mesh &mesh,
+      Stats &stats,
+      std::size_t target_number_of_vertices,
+      std::size_t target_number_of_triangles,
+      double sharp_angle_threshold,
+      std::size_t memory_budget)
+  {
     SMS::Simplify_stop_predicate<Surface_mesh> stop_predicate(
         target_number_of_triangles, target_number_of_vertices);
 
     using GH_cost = typename GH_policies::Get_cost;
     using GH_placement = typename GH_policies::Get_placement;
-    using Bounded_GH_placement = SMS::Bounded_normal_change_placement<GH_placement>;
+    using Bounded_GH_placement = SMS::Cached_bounded_normal_change_placement<GH_placement, Normal_cache>;
 
-    StatsVisitor vis(&stats, mesh, record_full_info);
+    auto stable_ids = add_stable_vertex_ids(mesh);
+    StatsVisitor<Level, Budgeted> vis(&stats, mesh, stable_ids, memory_budget, collapse_base_bytes(mesh, stats.cleaned_mesh));
+    if (vis.over_budget())
+    {
+      return;
+    }
+    // Without a budget the plain predicate is used, so the loop never checks the memory
+    auto stop = [&]
+    {
+      if constexpr (Budgeted)
+      {
+        return [&](const auto &cost, const auto &profile, std::size_t initial_count, std::size_t current_count)
+        {
+          return vis.over_budget() || stop_predicate(cost, profile, initial_count, current_count);
+        };
+      }
+      else
+      {
+        return stop_predicate;
+      }
+    }();
 
     GH_policies gh_policies(mesh);
     const GH_cost &gh_cost = gh_policies.get_cost();
     const GH_placement &gh_placement = gh_policies.get_placement();
-    Bounded_GH_placement bounded_gh_placement(gh_placement);
-
-    // Possibly constraint the sharp features
-    CGAL::Unique_hash_map<edge_descriptor, bool> constraint_hmap(false);
-    Constrained_edge_map constraints_map(constraint_hmap);
-    SMS::Constrained_placement<Bounded_GH_placement, Constrained_edge_map> constrained_placement(constraints_map, bounded_gh_placement);
+    Normal_cache normal_cache(mesh);
+    Bounded_GH_placement bounded_gh_placement(gh_placement, normal_cache);
+    SMS::Normal_cache_visitor<StatsVisitor<Level, Budgeted>, Normal_cache> cached_vis(vis, normal_cache);
 
-    bool detect_sharp_edges = sharp_angle_threshold > 0;
-    auto placement = detect_sharp_edges ? constrained_placement : bounded_gh_placement;
-    if (detect_sharp_edges)
+    if constexpr (ConstrainSharpEdges)
     {
+      // Constraint the sharp features
+      CGAL::Unique_hash_map<edge_descriptor, bool> constraint_hmap(false);
+      Constrained_edge_map constraints_map(constraint_hmap);
+      SMS::Constrained_placement<Bounded_GH_placement, Constrained_edge_map> constrained_placement(constraints_map, bounded_gh_placement);
+
       // detect sharp edges
       for (edge_descriptor ed : edges(mesh))
       {
@@ -122,53 +179,131 @@ namespace vr_tokenizer::cgal
           }
         }
       }
+
+      SMS::edge_collapse(
+          mesh,
+          stop,
+          CGAL::parameters::visitor(cached_vis)
+              .edge_is_constrained_map(constraints_map)
+              .get_cost(gh_cost)
+              .get_placement(constrained_placement));
     }
+    else
+    {
+      SMS::edge_collapse(
+          mesh,
+          stop,
+          CGAL::parameters::visitor(cached_vis)
+              .get_cost(gh_cost)
+              .get_placement(bounded_gh_placement));
+    }
+  }
 
-    SMS::edge_collapse(
-        mesh,
-        stop_predicate,
-        CGAL::parameters::visitor(vis)
-            .edge_is_constrained_map(constraints_map)
-            .get_cost(gh_cost)
-            .get_placement(placement));
+  // Turn a runtime flag into a compile-time constant passed to f
+  template <typename F>
+  decltype(auto) dispatch_bool(bool value, F &&f)
+  {
+    if (value)
+    {
+      return f(std::true_type{});
+    }
+    return f(std::false_type{});
+  }
 
-    return stats;
+  template <typename F>
+  decltype(auto) dispatch_record_level(RecordLevel level, F &&f)
+  {
+    switch (level)
+    {
+    case RecordLevel::FullInfo:
+      return f(std::integral_constant<RecordLevel, RecordLevel::FullInfo>{});
+    case RecordLevel::Columnar:
+      return f(std::integral_constant<RecordLevel, RecordLevel::Columnar>{});
+    default:
+      return f(std::integral_constant<RecordLevel, RecordLevel::Sequence>{});
+    }
+  }
+
+  // All policy choices are resolved here once, so the collapse loop is
+  // instantiated without branches on features that are turned off
+  void collapse_mesh(
+      Surface_mesh &mesh,
+      Stats &stats,
+      std::size_t target_number_of_vertices,
+      std::size_t target_number_of_triangles,
+      bool no_placement,
+      double sharp_angle_threshold,
+      RecordLevel level,
+      std::size_t memory_budget)
+  {
+    dispatch_bool(no_placement, [&](auto no_placement_c) {
+      using GH_policies = std::conditional_t<decltype(no_placement_c)::value, Classic_plane_no_placement, Classic_plane>;
+      dispatch_bool(sharp_angle_threshold > 0, [&](auto constrained_c) {
+        dispatch_record_level(level, [&](auto level_c) {
+          dispatch_bool(memory_budget > 0, [&](auto budgeted_c) {
+            edge_collapse_with_record_impl<GH_policies, decltype(constrained_c)::value, decltype(level_c)::value, decltype(budgeted_c)::value>(
+                mesh,
+                stats,
+                target_number_of_vertices,
+                target_number_of_triangles,
+                sharp_angle_threshold,
+                memory_budget);
+          });
+        });
+      });
+    });
   }
 
+  template <typename Scalar, typename Index>
   Stats edge_collapse_with_record(
-      const ArrayX3d &vertices,
-      const ArrayX3i &faces,
+      const VertexArray<Scalar> &vertices,
+      const FaceArray<Index> &faces,
       std::size_t target_number_of_vertices,
       std::size_t target_number_of_triangles,
       bool no_placement,
       double sharp_angle_threshold,
       bool strict,
-      bool record_full_info)
+      bool record_full_info,
+      std::size_t memory_budget,
+      bool columnar)
   {
-    if (no_placement)
+    if (columnar && record_full_info)
     {
-      return edge_collapse_with_record_impl<Classic_plane_no_placement>(
-          vertices,
-          faces,
-          target_number_of_vertices,
-          target_number_of_triangles,
-          sharp_angle_threshold,
-          strict,
-          record_full_info);
+      throw std::invalid_argument("Columnar output does not record full info");
     }
-    else
+    const auto level = columnar           ? RecordLevel::Columnar
+                       : record_full_info ? RecordLevel::FullInfo
+                                          : RecordLevel::Sequence;
+    Stats stats;
+    auto mesh = prepare_mesh(vertices, faces, strict, stats);
+    if (mesh)
     {
-      return edge_collapse_with_record_impl<Classic_plane>(
-          vertices,
-          faces,
-          target_number_of_vertices,
-          target_number_of_triangles,
-          sharp_angle_threshold,
-          strict,
-          record_full_info);
+      collapse_mesh(*mesh, stats, target_number_of_vertices, target_number_of_triangles,
+                    no_placement, sharp_angle_threshold, level, memory_budget);
     }
+    return stats;
   }
 
+#define INSTANTIATE_EDGE_COLLAPSE(Scalar, Index)           \
+  template Stats edge_collapse_with_record<Scalar, Index>( \
+      const VertexArray<Scalar> &,                         \
+      const FaceArray<Index> &,                            \
+      std::size_t,                                         \
+      std::size_t,                                         \
+      bool,                                                \
+      double,                                              \
+      bool,                                                \
+      bool,                                                \
+      std::size_t,                                         \
+      bool);
+
+  INSTANTIATE_EDGE_COLLAPSE(float, std::int32_t)
+  INSTANTIATE_EDGE_COLLAPSE(float, std::int64_t)
+  INSTANTIATE_EDGE_COLLAPSE(double, std::int32_t)
+  INSTANTIATE_EDGE_COLLAPSE(double, std::int64_t)
+
+#undef INSTANTIATE_EDGE_COLLAPSE
+
   inline void assert_hedge_valid(halfedge_descriptor h, const Surface_mesh &mesh, const std::string &msg)
   {
     if (!h.is_valid())
@@ -212,6 +347,8 @@ namespace vr_tokenizer::cgal
 
     auto p_t = Point_3(v_t.x(), v_t.y(), v_t.z());
 
+    vertex_descriptor v_new_;
+
     if (v_l_.has_value())
     {
       auto h2 = mesh.halfedge(*v_l_, v_s_);
@@ -224,6 +361,7 @@ namespace vr_tokenizer::cgal
         auto h_new_opp = mesh.opposite(h_new);
         auto v_t_ = mesh.source(h_new);
         mesh.point(v_t_) = p_t;
+        v_new_ = v_t_;
         if (mesh.is_border(h_new))
         {
           CGAL::Euler::add_face(CGAL::make_array(v_t_, v_s_, *v_l_), mesh);
@@ -260,6 +398,7 @@ namespace vr_tokenizer::cgal
           auto p_s = mesh.point(v_s_);
           mesh.point(v_s_) = p_t;
           auto v_new = mesh.add_vertex(p_s);
+          v_new_ = v_new;
           CGAL::Euler::add_face(CGAL::make_array(*v_l_, v_s_, v_new), mesh);
         }
         else
@@ -267,6 +406,7 @@ namespace vr_tokenizer::cgal
           auto h_new = CGAL::Euler::split_vertex(h1, h2, mesh);
           auto v_t_ = mesh.source(h_new);
           mesh.point(v_t_) = p_t;
+          v_new_ = v_t_;
           auto vLvT = mesh.halfedge(*v_l_, v_t_);
           assert_hedge_valid(vLvT, mesh, "Invalid vL, vT");
           assert_face_valid(h_new, mesh, "Invalid face at h_new after split");
@@ -286,6 +426,7 @@ namespace vr_tokenizer::cgal
         auto p_s = mesh.point(v_s_);
         mesh.point(v_s_) = p_t;
         auto v_new = mesh.add_vertex(p_s);
+        v_new_ = v_new;
         CGAL::Euler::add_face(CGAL::make_array(v_s_, *v_r_, v_new), mesh);
       }
       else
@@ -296,6 +437,7 @@ namespace vr_tokenizer::cgal
         auto h_new_opp = mesh.opposite(h_new);
         auto v_t_ = mesh.source(h_new);
         mesh.point(v_t_) = p_t;
+        v_new_ = v_t_;
         auto vTvR = mesh.halfedge(v_t_, *v_r_);
         assert_hedge_valid(vTvR, mesh, "Invalid vT, vR");
         assert_face_valid(h_new_opp, mesh, "Invalid face at h_new_opp after split");
@@ -7,15 +7,19 @@
 namespace vr_tokenizer::cgal
 {
 
+    // Instantiated for float/double vertices and int32/int64 faces
+    template <typename Scalar, typename Index>
     Stats edge_collapse_with_record(
-        const Eigen::ArrayX3d &vertices,
-        const Eigen::ArrayX3i &faces,
+        const VertexArray<Scalar> &vertices,
+        const FaceArray<Index> &faces,
         std::size_t target_number_of_vertices,
         std::size_t target_number_of_triangles,
         bool no_placement = false,
         double sharp_angle_threshold = -1,
         bool strict = false,
-        bool record_full_info = false);
+        bool record_full_info = false,
+        std::size_t memory_budget = 0,
+        bool columnar = false);
 
     std::optional<PolygonSoup> vertex_split(
         const Eigen::ArrayX3d &vertices,
@@ -0,0 +1,196 @@
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <numeric>
+#include <tuple>
+#include <utility>
+#include "simplify.h"
+#include "tokenize.h"
+
+namespace vr_tokenizer::cgal
+{
+
+    std::optional<Eigen::ArrayX3i> quantize_vertices(const Eigen::ArrayX3d &vertices, int num_pos_tokens)
+    {
+        using Row = Eigen::Array<double, 1, 3>;
+        if (vertices.rows() == 0 || !vertices.allFinite())
+        {
+            return std::nullopt;
+        }
+        const Row vmin = vertices.colwise().minCoeff();
+        const Row vmax = vertices.colwise().maxCoeff();
+        const Row center = (vmin + vmax) / 2;
+        const double extent = (vmax - vmin).maxCoeff();
+        if (!(extent > 0) || !std::isfinite(extent))
+        {
+            return std::nullopt;
+        }
+        const double scale = 2.0 / extent;
+        // Same operation order as the numpy implementation so that the levels match exactly
+        Eigen::ArrayX3i quantized(vertices.rows(), 3);
+        for (Eigen::Index i = 0; i < vertices.rows(); ++i)
+        {
+            for (Eigen::Index k = 0; k < 3; ++k)
+            {
+                const double v = ((vertices(i, k) - center(k)) * scale + 1) / 2;
+                const double level = std::floor(v * num_pos_tokens);
+                quantized(i, k) = static_cast<int>(std::clamp(level, 0.0, static_cast<double>(num_pos_tokens - 1)));
+            }
+        }
+        return quantized;
+    }
+
+    std::optional<std::vector<std::int32_t>> tokenize_raw_mesh(
+        const Eigen::ArrayX3d &vertices,
+        const Eigen::ArrayX3i &faces,
+        const TokenizerConfig &config)
+    {
+        if (vertices.rows() == 0 || faces.rows() == 0)
+        {
+            return std::nullopt;
+        }
+        const auto quantized = quantize_vertices(vertices, config.num_pos_tokens);
+        if (!quantized)
+        {
+            return std::nullopt;
+        }
+        const Stats stats = edge_collapse_with_record<double, std::int32_t>(
+            quantized->cast<double>(), faces, 3, 1,
+            true,  // no_placement, keep the quantized positions
+            -1,    // sharp_angle_threshold
+            true,  // strict
+            false, // record_full_info
+            0,     // memory_budget
+            true); // columnar
+        if (!stats.is_valid || stats.status != Status::Ok)
+        {
+            return std::nullopt;
+        }
+
+        const auto &all_vertices = stats.cleaned_mesh.vertices;
+        const auto &columns = stats.collapse_columns;
+        const Eigen::Index num_collapses = columns.indices.rows();
+        if (num_collapses == 0)
+        {
+            return std::nullopt;
+        }
+
+        // Orient every collapse so that v_s is the vertex keeping its position, as in
+        // quantized_edge_collapse, and replay it on the cleaned mesh: v_t merges into v_s
+        std::vector<std::array<std::int32_t, 4>> vsplit_seq(num_collapses);
+        std::vector<std::int32_t> parent(all_vertices.rows());
+        std::iota(parent.begin(), parent.end(), 0);
+        for (Eigen::Index i = 0; i < num_collapses; ++i)
+        {
+            std::int32_t v_s = columns.indices(i, 0);
+            std::int32_t v_t = columns.indices(i, 1);
+            std::int32_t v_l = columns.indices(i, 2);
+            std::int32_t v_r = columns.indices(i, 3);
+            if (v_l == -1 && v_r == -1)
+            {
+                return std::nullopt;
+            }
+            if ((columns.v_placement.row(i) == columns.v_t_p.row(i)).all())
+            {
+                std::swap(v_l, v_r);
+                std::swap(v_s, v_t);
+            }
+            vsplit_seq[i] = {v_s, v_l, v_r, v_t};
+            parent[v_t] = v_s;
+        }
+        auto find = [&](std::int32_t v)
+        {
+            std::int32_t root = v;
+            while (parent[root] != root)
+            {
+                root = parent[root];
+            }
+            while (parent[v] != root)
+            {
+                v = std::exchange(parent[v], root);
+            }
+            return root;
+        };
+
+        // The coarsest mesh: faces whose corners merged are gone, the others follow the merges
+        std::vector<std::array<std::int32_t, 3>> init_faces;
+        init_faces.reserve(stats.cleaned_mesh.faces.rows());
+        for (Eigen::Index i = 0; i < stats.cleaned_mesh.faces.rows(); ++i)
+        {
+            const std::array<std::int32_t, 3> face = {
+                find(stats.cleaned_mesh.faces(i, 0)),
+                find(stats.cleaned_mesh.faces(i, 1)),
+                find(stats.cleaned_mesh.faces(i, 2))};
+            if (face[0] != face[1] && face[1] != face[2] && face[2] != face[0])
+            {
+                init_faces.push_back(face);
+            }
+        }
+
+        // sort_quantized_mesh: vertices by (y, x, z), faces rotated to start at their smallest
+        // index and then sorted lexicographically
+        std::vector<std::int32_t> init_vertices;
+        for (std::int32_t v = 0; v < static_cast<std::int32_t>(parent.size()); ++v)
+        {
+            if (parent[v] == v)
+            {
+                init_vertices.push_back(v);
+            }
+        }
+        std::stable_sort(init_vertices.begin(), init_vertices.end(), [&](std::int32_t a, std::int32_t b)
+                         { return std::make_tuple(all_vertices(a, 1), all_vertices(a, 0), all_vertices(a, 2)) <
+                                  std::make_tuple(all_vertices(b, 1), all_vertices(b, 0), all_vertices(b, 2)); });
+        std::vector<std::int32_t> sorted_index(parent.size(), -1);
+        for (std::size_t i = 0; i < init_vertices.size(); ++i)
+        {
+            sorted_index[init_vertices[i]] = static_cast<std::int32_t>(i);
+        }
+        for (auto &face : init_faces)
+        {
+            for (auto &v : face)
+            {
+                v = sorted_index[v];
+            }
+            std::rotate(face.begin(), std::min_element(face.begin(), face.end()), face.end());
+        }
+        std::sort(init_faces.begin(), init_faces.end());
+
+        const auto pos_token = [&](std::int32_t v, Eigen::Index k)
+        {
+            return static_cast<std::int32_t>(all_vertices(v, k)) + config.pos_token_offset;
+        };
+        std::vector<std::int32_t> tokens;
+        tokens.reserve(3 + 9 * init_faces.size() + 12 * vsplit_seq.size());
+        tokens.push_back(config.bos_token_id);
+        for (const auto &face : init_faces)
+        {
+            for (const std::int32_t v : face)
+            {
+                for (Eigen::Index k = 0; k < 3; ++k)
+                {
+                    tokens.push_back(pos_token(init_vertices[v], k));
+                }
+            }
+        }
+        tokens.push_back(config.sep_token_id);
+        // Vertex splits undo the collapses, latest first
+        for (auto it = vsplit_seq.rbegin(); it != vsplit_seq.rend(); ++it)
+        {
+            for (const std::int32_t v : *it)
+            {
+                if (v == -1)
+                {
+                    tokens.push_back(config.nil_token_id);
+                    continue;
+                }
+                for (Eigen::Index k = 0; k < 3; ++k)
+                {
+                    tokens.push_back(pos_token(v, k));
+                }
+            }
+        }
+        tokens.push_back(config.eos_token_id);
+        return tokens;
+    }
+
+} // namespace vr_tokenizer::cgal
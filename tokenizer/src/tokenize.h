@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <vector>
+#include "common.h"
+
+namespace vr_tokenizer::cgal
+{
+    struct TokenizerConfig
+    {
+        int num_pos_tokens = 128;
+        std::int32_t bos_token_id = 1;
+        std::int32_t eos_token_id = 2;
+        std::int32_t sep_token_id = 3;
+        std::int32_t nil_token_id = 4;
+        std::int32_t pos_token_offset = 5;
+    };
+
+    // Normalize vertices to [-1, 1] and quantize them to num_pos_tokens levels per axis,
+    // like normalize_vertices followed by quantize_points in Python. Returns std::nullopt
+    // for non-finite coordinates or a zero extent, which cannot be normalized.
+    std::optional<Eigen::ArrayX3i> quantize_vertices(const Eigen::ArrayX3d &vertices, int num_pos_tokens);
+
+    // Quantize, collapse and tokenize a raw mesh, producing the same tokens as
+    // quantized_edge_collapse followed by tokenize_mesh in Python. Returns std::nullopt for
+    // meshes rejected by the strict collapse and for meshes without any collapse, which
+    // create_dataset skips as well.
+    std::optional<std::vector<std::int32_t>> tokenize_raw_mesh(
+        const Eigen::ArrayX3d &vertices,
+        const Eigen::ArrayX3i &faces,
+        const TokenizerConfig &config);
+
+} // namespace vr_tokenizer::cgal
@@ -1,5 +1,6 @@
 #include <CGAL/version.h>
 #include <CGAL/Polygon_mesh_processing/distance.h>
+#include <algorithm>
 #include "visitor.h"
 #include "mesh.h"
 
@@ -14,12 +15,60 @@ namespace vr_tokenizer::cgal
 
 #define TAG CGAL::Parallel_if_available_tag
 
-    StatsVisitor::StatsVisitor(Stats *s, const Surface_mesh &m, const bool &r)
-        : stats(s), mesh(m), record_full_info(r)
+    template <RecordLevel Level, bool Budgeted>
+    StatsVisitor<Level, Budgeted>::StatsVisitor(Stats *s, const Surface_mesh &m, Vertex_id_map ids, std::size_t budget, std::size_t base)
+        : stats(s), mesh(m), stable_ids(ids), memory_budget(budget), base_memory(base), fingerprint(s->cleaned_mesh.fingerprint)
     {
+        if constexpr (Budgeted)
+        {
+            update_memory();
+        }
+    }
+
+    template <RecordLevel Level, bool Budgeted>
+    void StatsVisitor<Level, Budgeted>::OnStarted(Surface_mesh &current_mesh)
+    {
+        if constexpr (Level == RecordLevel::Columnar)
+        {
+            // Every collapse removes one vertex, which bounds the number of rows
+            const Eigen::Index rows = current_mesh.number_of_vertices();
+            auto &columns = stats->collapse_columns;
+            columns.indices.resize(rows, 4);
+            columns.v_s_p.resize(rows, 3);
+            columns.v_t_p.resize(rows, 3);
+            columns.v_placement.resize(rows, 3);
+            columns.cost.resize(rows);
+            columns.fingerprint.resize(rows);
+            if constexpr (Budgeted)
+            {
+                update_memory();
+            }
+        }
+    }
+
+    template <RecordLevel Level, bool Budgeted>
+    void StatsVisitor<Level, Budgeted>::OnFinished(Surface_mesh &)
+    {
+        if constexpr (!Budgeted)
+        {
+            // History only grows during collapse, so the peak is reached here
+            update_memory();
+        }
+        if constexpr (Level == RecordLevel::Columnar)
+        {
+            const Eigen::Index rows = stats->collapsed;
+            auto &columns = stats->collapse_columns;
+            columns.indices.conservativeResize(rows, 4);
+            columns.v_s_p.conservativeResize(rows, 3);
+            columns.v_t_p.conservativeResize(rows, 3);
+            columns.v_placement.conservativeResize(rows, 3);
+            columns.cost.conservativeResize(rows);
+            columns.fingerprint.conservativeResize(rows);
+        }
     }
 
-    void StatsVisitor::OnCollapsing(const Profile &profile, const opt::optional<Point_3> &placement)
+    template <RecordLevel Level, bool Budgeted>
+    void StatsVisitor<Level, Budgeted>::OnCollapsing(const Profile &profile, const opt::optional<Point_3> &placement)
     {
         if (!placement)
         {
@@ -29,31 +78,97 @@ namespace vr_tokenizer::cgal
         const auto &p0 = profile.p0();
         const auto &p1 = profile.p1();
         const auto &current_mesh = profile.surface_mesh();
-        CollapseInfo info = {
-            profile.v1().idx(),                                                                                                               // v_s
-            profile.v0().idx(),                                                                                                               // v_t
-            point_to_vec(p1),                                                                                                                 // v_s_p
-            point_to_vec(p0),                                                                                                                 // v_t_p
-            point_to_vec(placement ? *placement : p1),                                                                                        // v_placement
-            profile.left_face_exists() ? std::make_optional<std::size_t>(profile.vL().idx()) : std::nullopt,                                  // v_l
-            profile.right_face_exists() ? std::make_optional<std::size_t>(profile.vR().idx()) : std::nullopt,                                 // v_r
-            profile.left_face_exists() ? std::make_optional<Eigen::Vector3d>(point_to_vec(current_mesh.point(profile.vL()))) : std::nullopt,  // v_l_p
-            profile.right_face_exists() ? std::make_optional<Eigen::Vector3d>(point_to_vec(current_mesh.point(profile.vR()))) : std::nullopt, // v_r_p
-            0.0,                                                                                                                              // dist
-            std::nullopt                                                                                                                      // collapsed_mesh
-        };
-        stats->collapse_sequence.emplace_back(info);
+        collapsing_v_s = stable_ids[profile.v1()];
+        collapsing_v_t = stable_ids[profile.v0()];
+        collapsing_v_t_p = point_to_vec(p0);
+        if constexpr (Level == RecordLevel::Columnar)
+        {
+            const Eigen::Index row = stats->collapsed;
+            auto &columns = stats->collapse_columns;
+            columns.indices(row, 0) = static_cast<std::int32_t>(collapsing_v_s);
+            columns.indices(row, 1) = static_cast<std::int32_t>(collapsing_v_t);
+            columns.indices(row, 2) = profile.left_face_exists() ? static_cast<std::int32_t>(stable_ids[profile.vL()]) : -1;
+            columns.indices(row, 3) = profile.right_face_exists() ? static_cast<std::int32_t>(stable_ids[profile.vR()]) : -1;
+            columns.v_s_p.row(row) = point_to_vec(p1).transpose().array();
+            columns.v_t_p.row(row) = collapsing_v_t_p.transpose().array();
+            columns.v_placement.row(row) = point_to_vec(placement ? *placement : p1).transpose().array();
+            columns.cost(row) = selected_cost;
+        }
+        else
+        {
+            CollapseInfo info = {
+                collapsing_v_s,                                                                                                                   // v_s
+                collapsing_v_t,                                                                                                                   // v_t
+                point_to_vec(p1),                                                                                                                 // v_s_p
+                collapsing_v_t_p,                                                                                                                 // v_t_p
+                point_to_vec(placement ? *placement : p1),                                                                                        // v_placement
+                profile.left_face_exists() ? std::make_optional<std::size_t>(stable_ids[profile.vL()]) : std::nullopt,                            // v_l
+                profile.right_face_exists() ? std::make_optional<std::size_t>(stable_ids[profile.vR()]) : std::nullopt,                           // v_r
+                profile.left_face_exists() ? std::make_optional<Eigen::Vector3d>(point_to_vec(current_mesh.point(profile.vL()))) : std::nullopt,  // v_l_p
+                profile.right_face_exists() ? std::make_optional<Eigen::Vector3d>(point_to_vec(current_mesh.point(profile.vR()))) : std::nullopt, // v_r_p
+                0.0,                                                                                                                              // dist
+                0,                                                                                                                                // fingerprint
+                std::nullopt                                                                                                                      // collapsed_mesh
+            };
+            stats->collapse_sequence.emplace_back(info);
+        }
+        // Faces around v0 and v1 are about to be removed or reshaped
+        fingerprint -= incident_faces_fingerprint(current_mesh, profile.v0());
+        fingerprint -= incident_faces_fingerprint(current_mesh, profile.v1(), profile.v0());
     }
 
-    void StatsVisitor::OnCollapsed(const Profile &profile, const vertex_descriptor &)
+    template <RecordLevel Level, bool Budgeted>
+    void StatsVisitor<Level, Budgeted>::OnCollapsed(const Profile &profile, const vertex_descriptor &v_kept)
     {
+        const Eigen::Index row = stats->collapsed;
         ++(stats->collapsed);
-        if (record_full_info)
+        const auto &current_mesh = profile.surface_mesh();
+        fingerprint += incident_faces_fingerprint(current_mesh, v_kept);
+        // The kept vertex takes the id of the endpoint whose position it now has,
+        // so ids keep naming the cleaned_mesh vertex at that position
+        stable_ids[v_kept] = point_to_vec(current_mesh.point(v_kept)) == collapsing_v_t_p ? collapsing_v_t : collapsing_v_s;
+        if constexpr (Level == RecordLevel::Columnar)
+        {
+            stats->collapse_columns.fingerprint(row) = fingerprint;
+        }
+        else
         {
             auto &info = stats->collapse_sequence.back();
-            const auto &current_mesh = profile.surface_mesh();
-            info.collapsed_mesh = mesh_to_polygon_soup(current_mesh);
+            info.fingerprint = fingerprint;
+            if constexpr (Level == RecordLevel::FullInfo)
+            {
+                info.collapsed_mesh = mesh_to_polygon_soup(current_mesh);
+                info.collapsed_mesh->fingerprint = fingerprint;
+                snapshot_memory += polygon_soup_bytes(*info.collapsed_mesh);
+            }
+            if constexpr (Budgeted)
+            {
+                update_memory();
+            }
         }
     }
 
+    template <RecordLevel Level, bool Budgeted>
+    void StatsVisitor<Level, Budgeted>::update_memory()
+    {
+        const auto &columns = stats->collapse_columns;
+        const std::size_t columns_memory = columns.indices.size() * sizeof(std::int32_t) +
+                                           (columns.v_s_p.size() + columns.v_t_p.size() + columns.v_placement.size() + columns.cost.size()) * sizeof(double) +
+                                           columns.fingerprint.size() * sizeof(std::uint64_t);
+        const std::size_t used = base_memory + snapshot_memory + columns_memory +
+                                 stats->collapse_sequence.capacity() * sizeof(CollapseInfo);
+        stats->peak_memory = std::max(stats->peak_memory, used);
+        if (memory_budget > 0 && used > memory_budget)
+        {
+            stats->status = Status::MemoryBudgetExceeded;
+        }
+    }
+
+    template struct StatsVisitor<RecordLevel::Sequence, false>;
+    template struct StatsVisitor<RecordLevel::FullInfo, false>;
+    template struct StatsVisitor<RecordLevel::Columnar, false>;
+    template struct StatsVisitor<RecordLevel::Sequence, true>;
+    template struct StatsVisitor<RecordLevel::FullInfo, true>;
+    template struct StatsVisitor<RecordLevel::Columnar, true>;
+
 } // namespace vr_tokenizer::cgal
\ No newline at end of file
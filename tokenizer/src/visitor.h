@@ -1,7 +1,9 @@
 #pragma once
 
 #include <CGAL/Surface_mesh_simplification/Edge_collapse_visitor_base.h>
+#include <limits>
 #include "common.h"
+#include "fingerprint.h"
 
 namespace vr_tokenizer::cgal
 {
@@ -13,9 +15,17 @@ namespace vr_tokenizer::cgal
     namespace opt = boost;
 #endif
 
+    // Records the collapse history into Stats. The recording level and whether a memory
+    // budget is enforced are template parameters so that disabled bookkeeping compiles away.
+    // Without a budget the memory is accounted once, when the collapse finishes.
+    template <RecordLevel Level, bool Budgeted>
     struct StatsVisitor : SMS::Edge_collapse_visitor_base<Surface_mesh>
     {
-        StatsVisitor(Stats *stats, const Surface_mesh &mesh, const bool &record_full_info);
+        StatsVisitor(Stats *stats, const Surface_mesh &mesh, Vertex_id_map stable_ids, std::size_t memory_budget, std::size_t base_memory);
+
+        void OnStarted(Surface_mesh &);
+
+        void OnFinished(Surface_mesh &);
 
         void OnCollected(const Profile &, const opt::optional<double> &)
         {
@@ -29,6 +39,7 @@ namespace vr_tokenizer::cgal
             {
                 ++(stats->cost_uncomputable);
             }
+            selected_cost = cost ? static_cast<double>(*cost) : std::numeric_limits<double>::quiet_NaN();
         }
 
         void OnCollapsing(const Profile &profile, const opt::optional<Point_3> &placement);
@@ -40,9 +51,31 @@ namespace vr_tokenizer::cgal
 
         void OnCollapsed(const Profile &profile, const vertex_descriptor &);
 
+        bool over_budget() const
+        {
+            return Budgeted && stats->status == Status::MemoryBudgetExceeded;
+        }
+
+        // Account for the recorded history and flag the run once the budget is exceeded
+        void update_memory();
+
         Stats *stats;
         const Surface_mesh &mesh;
-        const bool record_full_info;
+        // Index of every vertex in Stats::cleaned_mesh
+        Vertex_id_map stable_ids;
+        // Memory budget in bytes, 0 for unlimited
+        const std::size_t memory_budget;
+        // Estimated bytes of the mesh and collapse queue, which do not grow during collapse
+        const std::size_t base_memory;
+        std::size_t snapshot_memory = 0;
+        // Fingerprint of the current mesh, updated in O(degree) per collapse
+        Fingerprint fingerprint;
+        // Cost of the edge selected last, i.e. of the edge being collapsed
+        double selected_cost = 0.0;
+        // Endpoint ids and v0 position of the edge being collapsed
+        std::size_t collapsing_v_s = 0;
+        std::size_t collapsing_v_t = 0;
+        Eigen::Vector3d collapsing_v_t_p;
     };
 
 } // namespace vr_tokenizer::cgal
\ No newline at end of file
@@ -4,10 +4,15 @@ from ._vertexregen_tokenizer_pybind import (
     __doc__,
     __version__,
     edge_collapse_with_record,
+    check_polygon_soup,
     vertex_split,
+    mesh_fingerprint,
     PolygonSoup,
     CollapseInfo,
+    CollapseColumns,
     Stats,
+    Status,
+    TokenProducer,
 )
 from .collapse import quantized_edge_collapse
 from .tokenize import tokenize_mesh
@@ -16,10 +21,15 @@ __all__ = [
     "__doc__",
     "__version__",
     "edge_collapse_with_record",
+    "check_polygon_soup",
     "vertex_split",
+    "mesh_fingerprint",
     "PolygonSoup",
     "CollapseInfo",
+    "CollapseColumns",
     "Stats",
+    "Status",
+    "TokenProducer",
     "quantized_edge_collapse",
     "tokenize_mesh",
 ]
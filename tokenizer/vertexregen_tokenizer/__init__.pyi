@@ -1,17 +1,28 @@
 from __future__ import annotations
 
+from enum import Enum
 from typing import List, Sequence, Tuple, Optional
 import numpy as np
 from numpy.typing import NDArray
 
 __version__: str
 
+class Status(Enum):
+    OK = 0
+    INVALID_MESH = 1
+    MEMORY_BUDGET_EXCEEDED = 2  # collapse stopped early to stay within the memory budget
+    NON_MANIFOLD_EDGE = 3  # an edge is shared by more than two faces
+    NON_MANIFOLD_VERTEX = 4  # the faces around a vertex do not form a single fan
+    INCONSISTENT_ORIENTATION = 5  # faces cannot be oriented consistently
+
 class PolygonSoup:
     def __init__(self) -> None: ...
     vertices: NDArray[np.float64]  # shape: (N, 3)
     faces: NDArray[np.int64]  # shape: (M, 3)
+    fingerprint: int  # order-independent mesh fingerprint, 0 for vertex_split results
 
 class CollapseInfo:
+    # Vertex indices refer to Stats.cleaned_mesh
     def __init__(self) -> None: ...
     v_s: int
     v_t: int
@@ -23,12 +34,25 @@ class CollapseInfo:
     v_l_p: Optional[NDArray[np.float64]]  # prior position of v_l (3,)
     v_r_p: Optional[NDArray[np.float64]]  # prior position of v_r (3,)
     dist: float
+    fingerprint: int  # fingerprint of the mesh after this collapse
     collapsed_mesh: Optional[PolygonSoup]  # mesh snapshot after this collapse
 
+class CollapseColumns:
+    # One row per collapse, same numbering as CollapseInfo
+    def __init__(self) -> None: ...
+    indices: NDArray[np.int32]  # (N, 4): v_s, v_t, v_l, v_r with -1 for missing v_l / v_r
+    v_s_p: NDArray[np.float64]  # (N, 3)
+    v_t_p: NDArray[np.float64]  # (N, 3)
+    v_placement: NDArray[np.float64]  # (N, 3)
+    cost: NDArray[np.float64]  # (N,), NaN where not computable
+    fingerprint: NDArray[np.uint64]  # (N,) fingerprint of the mesh after each collapse
+
 class Stats:
     def __init__(self) -> None: ...
     cleaned_mesh: PolygonSoup
     is_valid: bool
+    status: Status
+    peak_memory: int  # estimated peak bytes of mesh, queue and recorded history
     collected: int
     processed: int
     collapsed: int
@@ -36,20 +60,28 @@ class Stats:
     cost_uncomputable: int
     placement_uncomputable: int
     num_sharp_edges: int
-    collapse_sequence: List[CollapseInfo]
+    collapse_sequence: List[CollapseInfo]  # empty when columnar=True
+    collapse_columns: CollapseColumns  # filled only when columnar=True
 
 
 def edge_collapse_with_record(
-    vertices: NDArray[np.float64],
-    faces: NDArray[np.int64],
+    vertices: NDArray[np.floating],  # float32 or float64
+    faces: NDArray[np.integer],  # int32 or int64
     target_number_of_vertices: int,
     target_number_of_triangles: int,
     no_placement: bool = False,
     sharp_angle_threshold: float = -1,
     strict: bool = False,
     record_full_info: bool = False,
+    memory_budget: int = 0,  # bytes, 0 for unlimited
+    columnar: bool = False,  # record into Stats.collapse_columns, incompatible with record_full_info
 ) -> Stats: ...
 
+def check_polygon_soup(
+    vertices: NDArray[np.floating],  # float32 or float64
+    faces: NDArray[np.integer],  # int32 or int64
+) -> Status: ...
+
 def vertex_split(
     vertices: NDArray[np.float64],
     faces: NDArray[np.int64],
@@ -58,3 +90,39 @@ def vertex_split(
     v_r: Optional[int],
     v_t: Sequence[float],  # expected length 3
 ) -> Optional[PolygonSoup]: ...
+
+def mesh_fingerprint(
+    vertices: NDArray[np.float64],
+    faces: NDArray[np.int64],
+) -> int: ...
+
+class TokenProducer:
+    # Samples arrive in completion order, not in the order of meshes
+    def __init__(
+        self,
+        meshes: Sequence[Tuple[NDArray[np.floating], NDArray[np.integer]]],
+        num_pos_tokens: int,
+        num_threads: int = 4,
+        capacity: int = 64,  # samples buffered ahead of the consumer
+        max_tokens: int = 0,  # longer samples are dropped, 0 for no limit
+        repeat: bool = False,  # cycle through meshes until stopped
+        random_rotation: bool = False,  # random rotation about the Y axis before quantization
+        scale_jitter: float = 0.0,  # per-axis scale in [1 - scale_jitter, 1 + scale_jitter], in [0, 1)
+        seed: int = 0,
+        bos_token_id: int = 1,
+        eos_token_id: int = 2,
+        sep_token_id: int = 3,
+        nil_token_id: int = 4,
+        pos_token_offset: int = 5,
+    ) -> None: ...
+    def __iter__(self) -> TokenProducer: ...
+    # (index into meshes, tokens); raises RuntimeError if repeat=True and a full pass
+    # over the meshes produced no sample
+    def __next__(self) -> Tuple[int, NDArray[np.int32]]: ...
+    def stop(self) -> None: ...
+    @property
+    def produced(self) -> int: ...
+    @property
+    def rejected(self) -> int: ...  # meshes rejected by the strict collapse
+    @property
+    def dropped(self) -> int: ...  # samples longer than max_tokens
@@ -1,8 +1,13 @@
 import numpy as np
 from collections import namedtuple
 
-from ._vertexregen_tokenizer_pybind import edge_collapse_with_record, vertex_split
-from .utils import normalize_vertices, quantize_points, sort_quantized_mesh
+from ._vertexregen_tokenizer_pybind import (
+    edge_collapse_with_record,
+    vertex_split,
+    mesh_fingerprint,
+    Status,
+)
+from .utils import normalize_vertices, quantize_points
 
 
 CollapseResult = namedtuple(
@@ -14,11 +19,13 @@ CollapseResult = namedtuple(
         "vertices",
         "faces",
         "vsplit_result_seq",
+        "vsplit_fingerprint_seq",
     ],
+    defaults=(None,),
 )
 
 
-def quantized_edge_collapse(vertices, faces, num_pos_tokens):
+def quantized_edge_collapse(vertices, faces, num_pos_tokens, memory_budget=0):
     vertices = np.array(vertices)
     vertices = normalize_vertices(vertices)
     quantized_vertices = quantize_points(vertices, num_pos_tokens)
@@ -32,48 +39,35 @@ def quantized_edge_collapse(vertices, faces, num_pos_tokens):
         sharp_angle_threshold=-1,
         strict=True,
         record_full_info=True,
+        memory_budget=memory_budget,  # bytes, 0 for unlimited
     )
-    if not stats.is_valid:
+    if not stats.is_valid or stats.status != Status.OK:
         return None
 
     vertices = np.array(stats.cleaned_mesh.vertices).astype(int)
     faces = np.array(stats.cleaned_mesh.faces).astype(int)
-    vertex_map = {tuple(v): i for i, v in enumerate(vertices)}
     collapse_info = []
     result_seq = [(vertices.copy(), faces.copy())]
+    fingerprint_seq = [stats.cleaned_mesh.fingerprint]
     for item in stats.collapse_sequence:
-        v_s = tuple(item.v_s_p.astype(int))
-        v_t = tuple(item.v_t_p.astype(int))
-        v_placement = tuple(item.v_placement.astype(int))
-        v_s = vertex_map.get(v_s, -1)
-        v_t = vertex_map.get(v_t, -1)
-        v_placement = vertex_map.get(v_placement, -1)
-        if v_s == -1 or v_t == -1 or v_placement == -1:
-            raise RuntimeError("Vertex mapping failed during collapse recording")
-        v_l = item.v_l_p
-        if v_l is not None:
-            v_l = tuple(v_l.astype(int))
-            v_l = vertex_map.get(v_l, -1)
-        else:
-            v_l = -1
-        v_r = item.v_r_p
-        if v_r is not None:
-            v_r = tuple(v_r.astype(int))
-            v_r = vertex_map.get(v_r, -1)
-        else:
-            v_r = -1
+        # Indices are reported w.r.t. the cleaned mesh
+        v_s, v_t = item.v_s, item.v_t
+        v_l = item.v_l if item.v_l is not None else -1
+        v_r = item.v_r if item.v_r is not None else -1
         if v_l == -1 and v_r == -1:
             raise RuntimeError("Both v_l and v_r are invalid during collapse recording")
-        if v_placement == v_t:
+        if np.array_equal(item.v_placement, item.v_t_p):
             v_l, v_r = v_r, v_l
             v_s, v_t = v_t, v_s
         collapse_info.append([v_s, v_l, v_r, v_t])
         _cur_vertices = np.array(item.collapsed_mesh.vertices).astype(int)
         _cur_faces = np.array(item.collapsed_mesh.faces).astype(int)
         result_seq.append((_cur_vertices, _cur_faces))
+        fingerprint_seq.append(item.fingerprint)
 
     collapse_info = np.array(collapse_info[::-1]).astype(int)
     result_seq = result_seq[::-1]
+    fingerprint_seq = fingerprint_seq[::-1]
     init_vertices, init_faces = result_seq[0]
     vsplit_result_seq = result_seq[1:]
     return CollapseResult(
@@ -83,6 +77,7 @@ def quantized_edge_collapse(vertices, faces, num_pos_tokens):
         vertices=vertices,
         faces=faces,
         vsplit_result_seq=vsplit_result_seq,
+        vsplit_fingerprint_seq=fingerprint_seq[1:],
     )
 
 
@@ -102,16 +97,16 @@ def edge_collapse_quantized_mesh(v, f, v_s, v_t):
     return v, f
 
 
-def compare_quantized_mesh(v1, f1, v2, f2):
+def compare_quantized_mesh(v1, f1, v2, f2, fp1=None, fp2=None):
+    # Meshes are compared by their order-independent fingerprints,
+    # which may be passed in when already known
     if v1.shape != v2.shape or f1.shape != f2.shape:
         return False
-    v1, f1 = sort_quantized_mesh(v1, f1)
-    v2, f2 = sort_quantized_mesh(v2, f2)
-    if not np.equal(v1, v2).all():
-        return False
-    if not np.equal(f1, f2).all():
-        return False
-    return True
+    if fp1 is None:
+        fp1 = mesh_fingerprint(v1, f1)
+    if fp2 is None:
+        fp2 = mesh_fingerprint(v2, f2)
+    return fp1 == fp2
 
 
 def validate_edge_collapse_sequence(info: CollapseResult):
@@ -123,6 +118,9 @@ def validate_edge_collapse_sequence(info: CollapseResult):
         (info.init_vertices.astype(int), info.init_faces.astype(int))
     ] + info.vsplit_result_seq
     gt_results = gt_results[::-1][1:]
+    gt_fingerprints = [None] * len(gt_results)
+    if info.vsplit_fingerprint_seq is not None:
+        gt_fingerprints = info.vsplit_fingerprint_seq[::-1][1:] + [None]
     for s_idx, (v_s, v_l, v_r, v_t) in enumerate(collapse_seq):
         if v_l == -1 and v_r == -1:
             return False
@@ -145,6 +143,7 @@ def validate_edge_collapse_sequence(info: CollapseResult):
             current_faces,
             gt_results[s_idx][0],
             gt_results[s_idx][1],
+            fp2=gt_fingerprints[s_idx],
         )
         if not mesh_equals:
             return False
@@ -156,6 +155,9 @@ def validate_vertex_split_sequence(info: CollapseResult):
     curr_faces = np.array(info.init_faces).astype(int)
     all_vertices = np.array(info.vertices).astype(int)
     vsplit_seq = info.vsplit_seq
+    gt_fingerprints = info.vsplit_fingerprint_seq
+    if gt_fingerprints is None:
+        gt_fingerprints = [None] * len(vsplit_seq)
     current_vertex_mapping = {tuple(v): i for i, v in enumerate(curr_vertices)}
     for s_idx, (v_s, v_l, v_r, v_t) in enumerate(vsplit_seq):
         v_s_p = tuple(all_vertices[v_s])
@@ -171,7 +173,14 @@ def validate_vertex_split_sequence(info: CollapseResult):
             return False
         gt_vertices, gt_faces = info.vsplit_result_seq[s_idx]
         try:
-            result = vertex_split(curr_vertices, curr_faces, v_s_i, v_l_i, v_r_i, v_t_p)
+            result = vertex_split(
+                curr_vertices,
+                curr_faces,
+                v_s_i,
+                v_l_i,
+                v_r_i,
+                v_t_p,
+            )
             if result is None:
                 return False
         except RuntimeError as ex:
@@ -179,7 +188,11 @@ def validate_vertex_split_sequence(info: CollapseResult):
         curr_vertices = np.array(result.vertices).astype(int)
         curr_faces = np.array(result.faces).astype(int)
         mesh_equals = compare_quantized_mesh(
-            curr_vertices, curr_faces, gt_vertices, gt_faces
+            curr_vertices,
+            curr_faces,
+            gt_vertices,
+            gt_faces,
+            fp2=gt_fingerprints[s_idx],
         )
         if not mesh_equals:
             return False